@@ -0,0 +1,16 @@
+# Benchmarks de kernels, carga de archivos y reconstrucción completa.
+# Escribe los resultados en JSON: ./benchmarks --salida resultados.json
+
+QT += core gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = benchmarks
+# Para poder compilar en el mismo directorio que Funciones_ordenamiento.pro
+MAKEFILE = Makefile.benchmarks
+OBJECTS_DIR = benchmarks_obj
+
+include(reconstruccion.pri)
+
+SOURCES += \
+        benchmarks.cpp
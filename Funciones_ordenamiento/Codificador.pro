@@ -0,0 +1,16 @@
+# Codificador: genera casos de prueba (I_D.bmp y M*.txt) a partir de
+# I_O.bmp, I_M.bmp, M.bmp y una secuencia de transformaciones.
+
+QT += core gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = codificador
+# Para poder compilar en el mismo directorio que Funciones_ordenamiento.pro
+MAKEFILE = Makefile.codificador
+OBJECTS_DIR = codificador_obj
+
+include(reconstruccion.pri)
+
+SOURCES += \
+        codificador.cpp
@@ -1,6 +1,8 @@
 QT += core gui
 CONFIG += console c++17
-CONFIG -= c++17 cmdline
+CONFIG -= app_bundle
+
+include(reconstruccion.pri)
 
 SOURCES += \
         main.cpp
@@ -0,0 +1,25 @@
+# Biblioteca de reconstrucción: la misma lógica que la aplicación, para
+# enlazarla desde otros programas (interfaz en reconstruccion.h).
+#
+#   qmake Reconstruccion.pro                                  -> libreconstruccion.a
+#   qmake Reconstruccion.pro CONFIG+=biblioteca_compartida    -> libreconstruccion.so / .dll
+#
+# Quien use la versión compartida en Windows debe definir
+# RECONSTRUCCION_COMPARTIDA para importar los símbolos.
+
+QT += core gui
+CONFIG += c++17
+
+TEMPLATE = lib
+TARGET = reconstruccion
+# Para poder compilar en el mismo directorio que Funciones_ordenamiento.pro
+MAKEFILE = Makefile.reconstruccion
+OBJECTS_DIR = reconstruccion_obj
+
+biblioteca_compartida {
+    DEFINES += RECONSTRUCCION_COMPARTIDA RECONSTRUCCION_CONSTRUYENDO
+} else {
+    CONFIG += staticlib
+}
+
+include(reconstruccion.pri)
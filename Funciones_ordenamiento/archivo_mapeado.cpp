@@ -0,0 +1,166 @@
+#include "archivo_mapeado.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool abrirArchivoMapeado(ArchivoMapeado& mapa, const char* ruta) {
+    mapa.datos = nullptr;
+    mapa.tamano = 0;
+    mapa.mapeo = nullptr;
+    mapa.archivo = CreateFileA(ruta, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (mapa.archivo == INVALID_HANDLE_VALUE) {
+        mapa.archivo = nullptr;
+        return false;
+    }
+    LARGE_INTEGER tamano;
+    if (!GetFileSizeEx(mapa.archivo, &tamano)) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    mapa.tamano = static_cast<size_t>(tamano.QuadPart);
+    if (mapa.tamano == 0) return true;
+
+    mapa.mapeo = CreateFileMappingA(mapa.archivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapa.mapeo) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    mapa.datos = static_cast<unsigned char*>(MapViewOfFile(mapa.mapeo, FILE_MAP_READ, 0, 0, 0));
+    if (!mapa.datos) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    return true;
+}
+
+bool crearArchivoMapeado(ArchivoMapeado& mapa, const char* ruta, size_t tamano) {
+    mapa.datos = nullptr;
+    mapa.tamano = tamano;
+    mapa.mapeo = nullptr;
+    mapa.archivo = CreateFileA(ruta, GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mapa.archivo == INVALID_HANDLE_VALUE) {
+        mapa.archivo = nullptr;
+        return false;
+    }
+    if (tamano == 0) return true;
+
+    unsigned long long t = tamano;
+    mapa.mapeo = CreateFileMappingA(mapa.archivo, nullptr, PAGE_READWRITE,
+                                    static_cast<DWORD>(t >> 32), static_cast<DWORD>(t), nullptr);
+    if (!mapa.mapeo) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    mapa.datos = static_cast<unsigned char*>(MapViewOfFile(mapa.mapeo, FILE_MAP_WRITE, 0, 0, 0));
+    if (!mapa.datos) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    return true;
+}
+
+void descartarPaginas(const ArchivoMapeado&, size_t, size_t) {
+}
+
+void cerrarArchivoMapeado(ArchivoMapeado& mapa) {
+    if (mapa.datos) UnmapViewOfFile(mapa.datos);
+    if (mapa.mapeo) CloseHandle(mapa.mapeo);
+    if (mapa.archivo) CloseHandle(mapa.archivo);
+    mapa.datos = nullptr;
+    mapa.tamano = 0;
+    mapa.mapeo = nullptr;
+    mapa.archivo = nullptr;
+}
+
+#else
+
+bool abrirArchivoMapeado(ArchivoMapeado& mapa, const char* ruta) {
+    mapa.datos = nullptr;
+    mapa.tamano = 0;
+    mapa.descriptor = open(ruta, O_RDONLY);
+    if (mapa.descriptor < 0) return false;
+
+    struct stat info;
+    if (fstat(mapa.descriptor, &info) != 0) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    mapa.tamano = static_cast<size_t>(info.st_size);
+    if (mapa.tamano == 0) return true;
+
+    void* p = mmap(nullptr, mapa.tamano, PROT_READ, MAP_PRIVATE, mapa.descriptor, 0);
+    if (p == MAP_FAILED) {
+        cerrarArchivoMapeado(mapa);
+        return false;
+    }
+    // Lectura secuencial: que el kernel adelante páginas agresivamente
+    madvise(p, mapa.tamano, MADV_SEQUENTIAL);
+    mapa.datos = static_cast<unsigned char*>(p);
+    return true;
+}
+
+bool crearArchivoMapeado(ArchivoMapeado& mapa, const char* ruta, size_t tamano) {
+    mapa.datos = nullptr;
+    mapa.tamano = tamano;
+    // Truncar el archivo existente daría SIGBUS a otro proceso que lo tenga
+    // mapeado (por ejemplo, dos ejecuciones que escriben reconstructed.bmp en
+    // el mismo directorio): se borra y se crea uno nuevo, y quien lo tenía
+    // mapeado sigue viendo el anterior
+    mapa.descriptor = -1;
+    for (int intento = 0; intento < 8 && mapa.descriptor < 0; ++intento) {
+        if (unlink(ruta) != 0 && errno != ENOENT) return false;
+        mapa.descriptor = open(ruta, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (mapa.descriptor < 0 && errno != EEXIST) return false;
+    }
+    if (mapa.descriptor < 0) return false;
+    if (tamano == 0) return true;
+
+    // Los bloques se reservan antes de mapear: con ftruncate el archivo
+    // quedaría disperso y, sin espacio en disco o sobre la cuota, escribir en
+    // el mapeo daría SIGBUS en lugar de un error
+    if (posix_fallocate(mapa.descriptor, 0, static_cast<off_t>(tamano)) != 0) {
+        cerrarArchivoMapeado(mapa);
+        unlink(ruta);
+        return false;
+    }
+    void* p = mmap(nullptr, tamano, PROT_READ | PROT_WRITE, MAP_SHARED, mapa.descriptor, 0);
+    if (p == MAP_FAILED) {
+        cerrarArchivoMapeado(mapa);
+        unlink(ruta);
+        return false;
+    }
+    mapa.datos = static_cast<unsigned char*>(p);
+    return true;
+}
+
+void descartarPaginas(const ArchivoMapeado& mapa, size_t inicio, size_t tamano) {
+    if (!mapa.datos || inicio >= mapa.tamano) return;
+    if (tamano > mapa.tamano - inicio) tamano = mapa.tamano - inicio;
+    // madvise necesita una dirección alineada a página: solo se descartan las
+    // páginas completamente dentro del tramo
+    size_t pagina = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t primera = (inicio + pagina - 1) / pagina * pagina;
+    size_t fin = (inicio + tamano) / pagina * pagina;
+    if (fin > primera) madvise(mapa.datos + primera, fin - primera, MADV_DONTNEED);
+}
+
+void cerrarArchivoMapeado(ArchivoMapeado& mapa) {
+    if (mapa.datos) munmap(mapa.datos, mapa.tamano);
+    if (mapa.descriptor >= 0) close(mapa.descriptor);
+    mapa.datos = nullptr;
+    mapa.tamano = 0;
+    mapa.descriptor = -1;
+}
+
+#endif
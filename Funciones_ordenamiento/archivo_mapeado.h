@@ -0,0 +1,41 @@
+#ifndef ARCHIVO_MAPEADO_H
+#define ARCHIVO_MAPEADO_H
+
+#include <cstddef>
+
+// ==============================================
+// ARCHIVOS MAPEADOS EN MEMORIA
+// ==============================================
+// Acceso a un archivo completo sin copiarlo: el sistema operativo carga las
+// páginas a medida que se leen (mmap en POSIX, MapViewOfFile en Windows).
+
+struct ArchivoMapeado {
+    unsigned char* datos;       // solo escribible si se creó con crearArchivoMapeado
+    size_t tamano;
+#ifdef _WIN32
+    void* archivo;
+    void* mapeo;
+#else
+    int descriptor;
+#endif
+};
+
+// Devuelve false si el archivo no existe o no se pudo mapear. Un archivo
+// vacío se abre correctamente con datos == nullptr y tamano == 0.
+bool abrirArchivoMapeado(ArchivoMapeado& mapa, const char* ruta);
+
+// Crea (o reemplaza) el archivo con el tamaño dado y lo mapea para escritura.
+// En POSIX el espacio se reserva antes de mapear, así que la falta de espacio
+// en disco devuelve false (y borra el archivo) en lugar de fallar al escribir.
+// Un archivo existente se borra en vez de truncarse: quien lo tenga mapeado
+// conserva su contenido.
+bool crearArchivoMapeado(ArchivoMapeado& mapa, const char* ruta, size_t tamano);
+
+// Libera las páginas de [inicio, inicio + tamano) que ya no se van a leer; si
+// se vuelven a leer se cargan otra vez del archivo. Solo para mapeos de
+// lectura. En Windows no hace nada.
+void descartarPaginas(const ArchivoMapeado& mapa, size_t inicio, size_t tamano);
+
+void cerrarArchivoMapeado(ArchivoMapeado& mapa);
+
+#endif // ARCHIVO_MAPEADO_H
@@ -0,0 +1,355 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "busqueda.h"
+#include "carga_datos.h"
+#include "enmascaramiento.h"
+#include "imagenes.h"
+#include "memoria.h"
+#include "operaciones_bits.h"
+
+using namespace std;
+
+// ==============================================
+// BENCHMARKS
+// ==============================================
+// Mide los kernels, la carga/exportación de archivos y la reconstrucción
+// completa sobre imágenes sintéticas, y escribe los resultados en JSON para
+// comparar entre versiones. Uso:
+//   benchmarks [--rapido] [--max-mpx N] [--max-profundidad N] [--threads N]
+//              [--salida resultados.json]
+
+typedef chrono::steady_clock Reloj;
+
+// Tiempo mínimo de cada medición repetida
+static const double SEGUNDOS_MINIMOS = 0.2;
+
+struct OpcionesBench {
+    bool rapido = false;
+    double maxMpx = 100.0;
+    int maxProfundidad = 6;
+    int numHilos = 1;
+    const char* salida = nullptr;
+};
+
+static double segundosDesde(Reloj::time_point inicio) {
+    return chrono::duration<double>(Reloj::now() - inicio).count();
+}
+
+// Repite 'funcion' hasta acumular SEGUNDOS_MINIMOS y devuelve el tiempo
+// medio por llamada (tras una llamada de calentamiento).
+template <typename Funcion>
+static double medirPromedio(Funcion funcion) {
+    funcion();
+    int repeticiones = 0;
+    Reloj::time_point inicio = Reloj::now();
+    double segundos = 0.0;
+    do {
+        funcion();
+        ++repeticiones;
+        segundos = segundosDesde(inicio);
+    } while (segundos < SEGUNDOS_MINIMOS);
+    return segundos / repeticiones;
+}
+
+// El mejor de 'repeticiones' tiempos: para operaciones de archivo, donde la
+// primera llamada y las siguientes no son comparables.
+template <typename Funcion>
+static double medirMejor(Funcion funcion, int repeticiones) {
+    double mejor = 0.0;
+    for (int r = 0; r < repeticiones; ++r) {
+        Reloj::time_point inicio = Reloj::now();
+        funcion();
+        double segundos = segundosDesde(inicio);
+        if (r == 0 || segundos < mejor) mejor = segundos;
+    }
+    return mejor;
+}
+
+static void llenarAleatorio(unsigned char* datos, size_t n, mt19937_64& generador) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v = generador();
+        memcpy(datos + i, &v, 8);
+    }
+    for (; i < n; ++i) datos[i] = static_cast<unsigned char>(generador());
+}
+
+// ==============================================
+// KERNELS
+// ==============================================
+
+static void medirKernels(FILE* json) {
+    fprintf(json, "  \"kernels\": [\n");
+    for (int n = SIMD_ESCALAR; n <= detectarNivelSIMD(); ++n) {
+        NivelSIMD nivel = static_cast<NivelSIMD>(n);
+        double gbXOR = medirRendimientoKernel(KERNEL_XOR, nivel, 64);
+        double gbRotacion = medirRendimientoKernel(KERNEL_ROTACION, nivel, 64);
+        double gbVerificacion = medirRendimientoKernel(KERNEL_VERIFICACION, nivel, 64);
+        fprintf(json, "    {\"nivel\": \"%s\", \"applyXOR_bytes_s\": %.0f, "
+                      "\"applyRotation_bytes_s\": %.0f, "
+                      "\"primeraDiferenciaSuma_bytes_s\": %.0f}%s\n",
+                nombreNivelSIMD(nivel), gbXOR * 1e9, gbRotacion * 1e9, gbVerificacion * 1e9,
+                n < detectarNivelSIMD() ? "," : "");
+        cerr << "kernels " << nombreNivelSIMD(nivel) << ": XOR " << gbXOR
+             << " GB/s, rotacion " << gbRotacion << " GB/s, verificacion "
+             << gbVerificacion << " GB/s" << endl;
+    }
+    fprintf(json, "  ],\n");
+}
+
+// verifyMasking en el peor caso: todos los bytes coinciden y recorre la
+// máscara entera. Se informa en bytes de máscara comparados por segundo.
+static void medirVerificacion(FILE* json, mt19937_64& generador) {
+    const int width = 1024, height = 1024, maskWidth = 256, maskHeight = 256;
+    size_t imgSize = static_cast<size_t>(width) * height * 3;
+    size_t maskSize = static_cast<size_t>(maskWidth) * maskHeight * 3;
+    BufferBytes imagen(imgSize), mask(maskSize), datos(maskSize);
+    llenarAleatorio(imagen.datos(), imgSize, generador);
+    llenarAleatorio(mask.datos(), maskSize, generador);
+    int seed = static_cast<int>(imgSize - maskSize / 2);   // cruza el final de la imagen
+    for (size_t k = 0; k < maskSize; ++k) {
+        datos.datos()[k] = static_cast<unsigned char>(imagen.datos()[(seed + k) % imgSize] +
+                                                      mask.datos()[k]);
+    }
+
+    bool ok = true;
+    double segundos = medirPromedio([&]() {
+        ok = verifyMasking(imagen.datos(), mask.datos(), width, height,
+                           maskWidth, maskHeight, seed, datos.datos()) && ok;
+    });
+    double bytesPorSegundo = maskSize / segundos;
+    fprintf(json, "  \"verifyMasking\": {\"bytes_s\": %.0f, \"correcto\": %s},\n",
+            bytesPorSegundo, ok ? "true" : "false");
+    cerr << "verifyMasking: " << bytesPorSegundo / 1e9 << " GB/s" << endl;
+}
+
+// ==============================================
+// CARGA Y EXPORTACIÓN
+// ==============================================
+
+static void medirCarga(FILE* json, const OpcionesBench& opciones, const string& directorio,
+                       mt19937_64& generador) {
+    // Imagen de 4 Mpx (1 Mpx en modo rápido)
+    int lado = opciones.rapido ? 1024 : 2048;
+    size_t imgSize = static_cast<size_t>(lado) * lado * 3;
+    BufferBytes imagen(imgSize);
+    llenarAleatorio(imagen.datos(), imgSize, generador);
+    string rutaImagen = directorio + "/imagen.bmp";
+
+    bool ok = true;
+    double exportar = medirMejor([&]() {
+        ok = exportImage(imagen.datos(), lado, lado, QString::fromStdString(rutaImagen)) && ok;
+    }, 3);
+    double cargar = medirMejor([&]() {
+        int w, h;
+        BufferBytes leida = loadPixels(QString::fromStdString(rutaImagen), w, h);
+        ok = leida && w == lado && h == lado && memcmp(leida.datos(), imagen.datos(), imgSize) == 0 && ok;
+    }, 3);
+
+    // Archivo de enmascaramiento de 1M píxeles (256K en modo rápido) con
+    // sumas de hasta 510, como los reales
+    int pixeles = opciones.rapido ? 256 * 1024 : 1024 * 1024;
+    string rutaTexto = directorio + "/M1.txt";
+    FILE* archivo = fopen(rutaTexto.c_str(), "w");
+    if (!archivo) {
+        cerr << "No se pudo escribir " << rutaTexto << endl;
+        exit(1);
+    }
+    fprintf(archivo, "%d\n", 12345);
+    for (int i = 0; i < pixeles; ++i) {
+        fprintf(archivo, "%d %d %d\n", static_cast<int>(generador() % 511),
+                static_cast<int>(generador() % 511), static_cast<int>(generador() % 511));
+    }
+    fclose(archivo);
+    size_t bytesTexto = filesystem::file_size(rutaTexto);
+    char rutaBinaria[1024];
+    rutaMascaraBinaria(rutaTexto.c_str(), rutaBinaria, sizeof(rutaBinaria));
+
+    // Texto: se borra el binario antes de cada carga (incluye escribirlo)
+    double texto = medirMejor([&]() {
+        filesystem::remove(rutaBinaria);
+        int seed, n;
+        BufferBytes datos = loadSeedMasking(rutaTexto.c_str(), seed, n);
+        ok = datos && n == pixeles && ok;
+    }, 3);
+    double binario = medirMejor([&]() {
+        int seed, n;
+        BufferBytes datos = loadSeedMasking(rutaTexto.c_str(), seed, n);
+        ok = datos && n == pixeles && ok;
+    }, 5);
+
+    fprintf(json, "  \"carga\": {\n");
+    fprintf(json, "    \"imagen_mpx\": %.3f,\n", lado * static_cast<double>(lado) / 1e6);
+    fprintf(json, "    \"exportImage_bytes_s\": %.0f,\n", imgSize / exportar);
+    fprintf(json, "    \"loadPixels_bytes_s\": %.0f,\n", imgSize / cargar);
+    fprintf(json, "    \"mascara_pixeles\": %d,\n", pixeles);
+    fprintf(json, "    \"loadSeedMasking_texto_bytes_s\": %.0f,\n", bytesTexto / texto);
+    fprintf(json, "    \"loadSeedMasking_texto_pixeles_s\": %.0f,\n", pixeles / texto);
+    fprintf(json, "    \"loadSeedMasking_binario_pixeles_s\": %.0f,\n", pixeles / binario);
+    fprintf(json, "    \"correcto\": %s\n", ok ? "true" : "false");
+    fprintf(json, "  },\n");
+    cerr << "exportImage: " << imgSize / exportar / 1e6 << " MB/s, loadPixels: "
+         << imgSize / cargar / 1e6 << " MB/s" << endl;
+    cerr << "loadSeedMasking: texto " << bytesTexto / texto / 1e6 << " MB/s, binario "
+         << pixeles / binario / 1e6 << " Mpx/s" << endl;
+}
+
+// ==============================================
+// RECONSTRUCCIÓN COMPLETA
+// ==============================================
+
+// Genera un caso sintético (I_O e I_M aleatorias, T[0] = XOR y el resto de
+// transformaciones al azar, un archivo de enmascaramiento por etapa
+// intermedia) y mide reconstructImage sobre él.
+static bool medirCaso(FILE* json, bool primero, double mpx, int profundidad,
+                      const OpcionesBench& opciones, mt19937_64& generador) {
+    int width = static_cast<int>(sqrt(mpx * 1e6));
+    int height = static_cast<int>(mpx * 1e6 / width);
+    const int maskWidth = 32, maskHeight = 32;
+    size_t imgSize = static_cast<size_t>(width) * height * 3;
+    int maskSize = maskWidth * maskHeight * 3;
+    int numTransformations = profundidad - 1;
+
+    BufferBytes original(imgSize), IM(imgSize), imagen(imgSize), mask(maskSize);
+    llenarAleatorio(original.datos(), imgSize, generador);
+    llenarAleatorio(IM.datos(), imgSize, generador);
+    llenarAleatorio(mask.datos(), maskSize, generador);
+    memcpy(imagen.datos(), original.datos(), imgSize);
+
+    Transformation todas[NUM_TRANSFORMACIONES];
+    int numTodas;
+    generatePossibleTransformations(todas, numTodas);
+
+    BufferBytes datosEnmascaramiento[MAX_PASOS];
+    unsigned char* maskingDataArray[MAX_PASOS];
+    int seeds[MAX_PASOS];
+    for (int s = 0; s < profundidad; ++s) {
+        // T[0] nunca se verifica: la búsqueda toma la primera del catálogo
+        Transformation t = s == 0 ? todas[0] : todas[generador() % numTodas];
+        applyTransformation(imagen.datos(), IM.datos(), t, imgSize);
+        if (s + 1 < profundidad) {
+            seeds[s] = static_cast<int>(generador() % imgSize);
+            datosEnmascaramiento[s] = BufferBytes(maskSize);
+            maskingDataArray[s] = datosEnmascaramiento[s].datos();
+            for (int k = 0; k < maskSize; ++k) {
+                maskingDataArray[s][k] = static_cast<unsigned char>(
+                    imagen.datos()[(seeds[s] + static_cast<size_t>(k)) % imgSize] +
+                    mask.datos()[k]);
+            }
+        }
+    }
+
+    OpcionesBusqueda busqueda;
+    busqueda.numHilos = opciones.numHilos;
+    busqueda.profundidad = profundidad;
+    Transformation secuencia[MAX_PASOS];
+    Reloj::time_point inicio = Reloj::now();
+    unique_ptr<unsigned char[]> resultado(
+        reconstructImage(imagen.datos(), IM.datos(), mask.datos(), width, height,
+                         maskWidth, maskHeight, maskingDataArray, seeds,
+                         numTransformations, secuencia, busqueda));
+    double segundos = segundosDesde(inicio);
+    bool correcto = resultado && memcmp(resultado.get(), original.datos(), imgSize) == 0;
+
+    fprintf(json, "%s    {\"mpx\": %.3f, \"width\": %d, \"height\": %d, \"profundidad\": %d, "
+                  "\"segundos\": %.6f, \"bytes_s\": %.0f, \"correcto\": %s}",
+            primero ? "" : ",\n", width * static_cast<double>(height) / 1e6, width, height,
+            profundidad, segundos, imgSize / segundos, correcto ? "true" : "false");
+    cerr << "reconstructImage " << mpx << " Mpx, profundidad " << profundidad << ": "
+         << segundos * 1000.0 << " ms" << (correcto ? "" : " (INCORRECTO)") << endl;
+    return correcto;
+}
+
+static void medirReconstruccion(FILE* json, const OpcionesBench& opciones,
+                                mt19937_64& generador) {
+    const double tamanos[] = {0.1, 1.0, 10.0, 100.0};
+    fprintf(json, "  \"reconstruccion\": [\n");
+    bool primero = true;
+    for (double mpx : tamanos) {
+        if (mpx > opciones.maxMpx) break;
+        for (int profundidad = 1; profundidad <= opciones.maxProfundidad; ++profundidad) {
+            medirCaso(json, primero, mpx, profundidad, opciones, generador);
+            primero = false;
+        }
+    }
+    fprintf(json, "\n  ]\n");
+}
+
+// ==============================================
+// FUNCIÓN PRINCIPAL
+// ==============================================
+
+int main(int argc, char* argv[]) {
+    OpcionesBench opciones;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--rapido") == 0) {
+            opciones.rapido = true;
+            opciones.maxMpx = 1.0;
+            opciones.maxProfundidad = 4;
+        } else if (strcmp(argv[i], "--max-mpx") == 0 && i + 1 < argc) {
+            opciones.maxMpx = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-profundidad") == 0 && i + 1 < argc) {
+            opciones.maxProfundidad = atoi(argv[++i]);
+            if (opciones.maxProfundidad < 1 || opciones.maxProfundidad > MAX_PASOS) {
+                cerr << "La profundidad debe estar entre 1 y " << MAX_PASOS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opciones.numHilos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) {
+            opciones.salida = argv[++i];
+        } else {
+            cerr << "Opcion desconocida: " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    FILE* json = opciones.salida ? fopen(opciones.salida, "w") : stdout;
+    if (!json) {
+        cerr << "No se pudo escribir " << opciones.salida << endl;
+        return 1;
+    }
+
+    // Los archivos de prueba van a un directorio temporal propio
+    error_code error;
+    string directorio = (filesystem::temp_directory_path(error) /
+                         ("benchmarks_desafio_" + to_string(random_device()()))).string();
+    filesystem::create_directories(directorio, error);
+    if (error) {
+        cerr << "No se pudo crear " << directorio << endl;
+        return 1;
+    }
+
+    // Semilla fija: los mismos casos en cada ejecución
+    mt19937_64 generador(20240501);
+    char fecha[32];
+    time_t ahora = time(nullptr);
+    strftime(fecha, sizeof(fecha), "%Y-%m-%dT%H:%M:%SZ", gmtime(&ahora));
+
+    fprintf(json, "{\n");
+    fprintf(json, "  \"formato\": 1,\n");
+    fprintf(json, "  \"fecha\": \"%s\",\n", fecha);
+    fprintf(json, "  \"simd\": \"%s\",\n", nombreNivelSIMD(nivelSIMDActivo()));
+    fprintf(json, "  \"nucleos\": %u,\n", thread::hardware_concurrency());
+    fprintf(json, "  \"hilos_busqueda\": %d,\n", opciones.numHilos);
+    medirKernels(json);
+    medirVerificacion(json, generador);
+    medirCarga(json, opciones, directorio, generador);
+    medirReconstruccion(json, opciones, generador);
+    fprintf(json, "}\n");
+
+    if (json != stdout) fclose(json);
+    filesystem::remove_all(directorio, error);
+    return 0;
+}
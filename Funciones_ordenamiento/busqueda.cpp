@@ -0,0 +1,704 @@
+#include "busqueda.h"
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "cache_secuencias.h"
+#include "memoria.h"
+#include "operaciones_bits.h"
+#include "perfilado.h"
+
+// Deshace una sola transformación sobre n bytes de la ventana.
+static void deshacerPaso(const Transformation& t, unsigned char* destino,
+                         const unsigned char* origen, const unsigned char* IM, int n) {
+    ProgramaInverso programa;
+    compilarInversa(&t, 1, programa);
+    ejecutarPrograma(programa, destino, origen, IM, n);
+}
+
+// Deshace 't' para obtener Ps ('etapa') y lo verifica contra M<s>.txt si
+// esa etapa tiene archivo. Casi todos los candidatos fallan en los primeros
+// bytes, así que primero se deshace solo el tramo de esa semilla y, si
+// coincide, los de las semillas de etapas anteriores. Los tramos de etapas
+// ya verificadas no vuelven a hacer falta y no se tocan.
+static bool deshacerYVerificar(const VentanaDispersa& ventana, const Transformation& t,
+                               unsigned char* destino, const unsigned char* origen, int etapa,
+                               unsigned char* mask, unsigned char** maskingDataArray) {
+    contarPerfil(CONTADOR_CANDIDATOS, 1);
+    int maskSize = ventana.maskSize;
+    if (etapa >= 1 && etapa <= ventana.numSemillas) {
+        int offset = (etapa - 1) * maskSize;
+        deshacerPaso(t, destino + offset, origen + offset, ventana.IM + offset, maskSize);
+        if (!verificarTramo(destino + offset, mask, maskSize, maskingDataArray[etapa - 1])) {
+            return false;
+        }
+        deshacerPaso(t, destino, origen, ventana.IM, offset);
+        return true;
+    }
+    // Etapa sin archivo: solo hacen falta las semillas de etapas anteriores
+    int semillas = etapa < ventana.numSemillas ? etapa : ventana.numSemillas;
+    deshacerPaso(t, destino, origen, ventana.IM, semillas * maskSize);
+    return true;
+}
+
+bool verificarPorEtapas(VentanaDispersa& ventana, unsigned char* mask,
+                        unsigned char** maskingDataArray,
+                        const Transformation* candidato, int profundidad) {
+    const unsigned char* origen = ventana.imagen;
+    for (int s = profundidad - 1; s >= 0; --s) {
+        if (!deshacerYVerificar(ventana, candidato[s], ventana.trabajo, origen, s,
+                                mask, maskingDataArray)) {
+            return false;
+        }
+        origen = ventana.trabajo;
+    }
+    return true;
+}
+
+// ==============================================
+// BÚSQUEDA EN PROFUNDIDAD
+// ==============================================
+
+struct EstadoDFS {
+    VentanaDispersa* ventana;
+    unsigned char* mask;
+    unsigned char** maskingDataArray;
+    int profundidad;
+    Transformation catalogo[NUM_TRANSFORMACIONES];
+    int numOps;
+    // niveles[L] es la ventana tras deshacer L transformaciones (solo son
+    // válidos los tramos de las semillas que quedan por verificar). Salen de
+    // la arena del hilo, así que una búsqueda repetida no reserva nada.
+    unsigned char* niveles[MAX_PASOS + 1];
+    ArenaTemporal::Marca marcaArena;
+    Transformation* secuencia;
+    // Búsqueda paralela: la tarea actual se abandona en cuanto otra de menor
+    // índice (anterior en orden serial) ya encontró una secuencia.
+    const std::atomic<long long>* mejorTarea;
+    long long tareaActual;
+};
+
+static void iniciarEstado(EstadoDFS& estado, VentanaDispersa& ventana, unsigned char* mask,
+                          unsigned char** maskingDataArray, int profundidad,
+                          Transformation* secuencia) {
+    estado.ventana = &ventana;
+    estado.mask = mask;
+    estado.maskingDataArray = maskingDataArray;
+    estado.profundidad = profundidad;
+    estado.secuencia = secuencia;
+    estado.mejorTarea = nullptr;
+    estado.tareaActual = 0;
+    generarCatalogoCanonico(estado.catalogo, estado.numOps);
+
+    int n = ventana.numSemillas * ventana.maskSize;
+    ArenaTemporal& arena = arenaDelHilo();
+    estado.marcaArena = arena.marca();
+    estado.niveles[0] = ventana.imagen;
+    for (int i = 1; i <= profundidad; ++i) {
+        estado.niveles[i] = arena.reservar(n);
+    }
+}
+
+// Debe llamarse desde el mismo hilo que iniciarEstado
+static void liberarEstado(EstadoDFS& estado) {
+    arenaDelHilo().volverA(estado.marcaArena);
+}
+
+// Deshace la operación 'op' del catálogo canónico en el nivel indicado y
+// verifica la etapa resultante.
+static bool avanzarNivel(EstadoDFS& estado, int nivel, int op) {
+    int etapa = estado.profundidad - 1 - nivel;
+    // Si la imagen entre esta etapa y la ya deshecha no se verifica, solo se
+    // exploran combinaciones canónicas
+    if (nivel > 0 && etapa + 1 > estado.ventana->numSemillas &&
+        !admiteCanonico(estado.catalogo[op], estado.secuencia[etapa + 1])) {
+        return false;
+    }
+    if (!deshacerYVerificar(*estado.ventana, estado.catalogo[op], estado.niveles[nivel + 1],
+                            estado.niveles[nivel], etapa, estado.mask,
+                            estado.maskingDataArray)) {
+        return false;
+    }
+    estado.secuencia[etapa] = estado.catalogo[op];
+    return true;
+}
+
+static bool explorar(EstadoDFS& estado, int nivel) {
+    if (nivel == estado.profundidad) return true;
+
+    for (int op = 0; op < estado.numOps; ++op) {
+        if (estado.mejorTarea &&
+            estado.mejorTarea->load(std::memory_order_relaxed) < estado.tareaActual) {
+            return false;
+        }
+        if (avanzarNivel(estado, nivel, op) && explorar(estado, nivel + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool buscarSecuenciaDFS(VentanaDispersa& ventana, unsigned char* mask,
+                        unsigned char** maskingDataArray, int profundidad,
+                        Transformation* secuencia) {
+    if (profundidad < 1 || profundidad > MAX_PASOS) return false;
+
+    EstadoDFS estado;
+    iniciarEstado(estado, ventana, mask, maskingDataArray, profundidad, secuencia);
+    bool encontrada = explorar(estado, 0);
+    liberarEstado(estado);
+    return encontrada;
+}
+
+// ==============================================
+// SOLUCIÓN ANALÍTICA POR ETAPAS
+// ==============================================
+// Si Ps tiene archivo, sus bytes en la ventana deben ser
+// maskingData[k] - mask[k]; basta ver qué transformación del catálogo lleva
+// los bytes actuales a esos valores.
+
+// Cuenta las transformaciones del catálogo que, deshechas en el nivel dado,
+// producen los valores esperados en el tramo de la etapa. Deja en 'unica' el
+// índice de la primera.
+static int transformacionesCompatibles(EstadoDFS& estado, int nivel,
+                                       const unsigned char* esperado,
+                                       unsigned char* tramo, int& unica) {
+    int etapa = estado.profundidad - 1 - nivel;
+    int maskSize = estado.ventana->maskSize;
+    int offset = (etapa - 1) * maskSize;
+    int compatibles = 0;
+    unica = -1;
+    for (int op = 0; op < estado.numOps; ++op) {
+        if (nivel > 0 && etapa + 1 > estado.ventana->numSemillas &&
+            !admiteCanonico(estado.catalogo[op], estado.secuencia[etapa + 1])) {
+            continue;
+        }
+        contarPerfil(CONTADOR_CANDIDATOS, 1);
+        deshacerPaso(estado.catalogo[op], tramo, estado.niveles[nivel] + offset,
+                     estado.ventana->IM + offset, maskSize);
+        if (memcmp(tramo, esperado, maskSize) == 0) {
+            if (compatibles++ == 0) unica = op;
+        }
+    }
+    return compatibles;
+}
+
+bool resolverPorEtapas(VentanaDispersa& ventana, unsigned char* mask,
+                       unsigned char** maskingDataArray, int profundidad,
+                       Transformation* secuencia, int* etapasAmbiguas) {
+    if (profundidad < 1 || profundidad > MAX_PASOS) return false;
+
+    EstadoDFS estado;
+    iniciarEstado(estado, ventana, mask, maskingDataArray, profundidad, secuencia);
+    unsigned char* esperado = arenaDelHilo().reservar(ventana.maskSize);
+    unsigned char* tramo = arenaDelHilo().reservar(ventana.maskSize);
+
+    bool encontrada = false;
+    int nivel = 0;
+    for (; nivel < profundidad; ++nivel) {
+        int etapa = profundidad - 1 - nivel;
+        if (etapa < 1 || etapa > ventana.numSemillas) break;   // etapa sin archivo
+
+        for (int k = 0; k < ventana.maskSize; ++k) {
+            esperado[k] = static_cast<unsigned char>(maskingDataArray[etapa - 1][k] - mask[k]);
+        }
+        int op;
+        int compatibles = transformacionesCompatibles(estado, nivel, esperado, tramo, op);
+        if (compatibles != 1) break;
+
+        // La transformación está determinada: se deshace en toda la ventana
+        if (!avanzarNivel(estado, nivel, op)) break;
+    }
+
+    // Etapa ambigua o sin archivo: búsqueda exhaustiva desde aquí. Si no hubo
+    // ninguna compatible, explorar lo confirma sin recorrer nada más.
+    if (etapasAmbiguas) *etapasAmbiguas = profundidad - nivel;
+    encontrada = explorar(estado, nivel);
+
+    liberarEstado(estado);   // también devuelve 'esperado' y 'tramo'
+    return encontrada;
+}
+
+long long contarSecuenciasCanonicas(int profundidad, int numSemillas) {
+    // Programación dinámica sobre la clase de la última transformación
+    // deshecha: 0 = XOR, 1 = rotación no trivial, 2 = identidad.
+    const int ROTACIONES = MAX_BITS - 1;
+    long long cuenta[3] = {1, 0, 0};   // nivel 0: una secuencia vacía
+    bool vacia = true;
+    for (int nivel = 0; nivel < profundidad; ++nivel) {
+        int etapa = profundidad - 1 - nivel;
+        bool libre = vacia || etapa + 1 <= numSemillas;
+        long long total = cuenta[0] + cuenta[1] + cuenta[2];
+        long long nueva[3];
+        if (libre) {
+            nueva[0] = total;
+            nueva[1] = total * ROTACIONES;
+            nueva[2] = total;
+        } else {
+            nueva[0] = cuenta[1];
+            nueva[1] = cuenta[0] * ROTACIONES;
+            nueva[2] = total;
+        }
+        for (int c = 0; c < 3; ++c) cuenta[c] = nueva[c];
+        vacia = false;
+    }
+    return cuenta[0] + cuenta[1] + cuenta[2];
+}
+
+// ==============================================
+// BÚSQUEDA PARALELA CON ROBO DE TRABAJO
+// ==============================================
+// Cada tarea es un prefijo de los primeros niveles, numerado en orden serial.
+// Cada hilo recibe un rango contiguo de tareas y las toma desde el principio;
+// cuando se le acaba, roba la mitad final del rango de otro hilo. Los rangos
+// son un único entero atómico (inicio en los 32 bits bajos, fin en los
+// altos), así que tomar y robar son un CAS, sin cerrojos.
+
+struct alignas(64) RangoTareas {
+    std::atomic<uint64_t> rango;
+};
+
+static uint64_t empaquetarRango(uint32_t inicio, uint32_t fin) {
+    return (static_cast<uint64_t>(fin) << 32) | inicio;
+}
+
+static long long tomarTarea(RangoTareas& propio) {
+    uint64_t r = propio.rango.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t inicio = static_cast<uint32_t>(r);
+        uint32_t fin = static_cast<uint32_t>(r >> 32);
+        if (inicio >= fin) return -1;
+        if (propio.rango.compare_exchange_weak(r, empaquetarRango(inicio + 1, fin),
+                                               std::memory_order_acq_rel)) {
+            return inicio;
+        }
+    }
+}
+
+static bool robarTareas(RangoTareas& victima, RangoTareas& propio) {
+    uint64_t r = victima.rango.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t inicio = static_cast<uint32_t>(r);
+        uint32_t fin = static_cast<uint32_t>(r >> 32);
+        if (inicio >= fin) return false;
+        uint32_t mitad = inicio + (fin - inicio) / 2;
+        if (victima.rango.compare_exchange_weak(r, empaquetarRango(inicio, mitad),
+                                                std::memory_order_acq_rel)) {
+            propio.rango.store(empaquetarRango(mitad, fin), std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+struct BusquedaParalela {
+    VentanaDispersa* ventana;
+    unsigned char* mask;
+    unsigned char** maskingDataArray;
+    int profundidad;
+    int nivelesPrefijo;        // niveles que forman cada tarea
+    // La tarea local j es el prefijo número primeraTarea + j * pasoTareas
+    long long primeraTarea;
+    long long pasoTareas;
+    std::atomic<long long>* tareasHechas;   // puede ser nulo
+    int numHilos;
+    RangoTareas* rangos;
+    std::atomic<long long> mejorTarea;
+    // Resultado de cada hilo (solo lo escribe su dueño)
+    long long* tareaEncontrada;
+    Transformation (*secuencias)[MAX_PASOS];
+    // Trabajadores de HilosBusqueda que aún no terminaron
+    std::mutex mutexFin;
+    std::condition_variable fin;
+    int pendientes;
+};
+
+static void actualizarMinimo(std::atomic<long long>& minimo, long long valor) {
+    long long actual = minimo.load(std::memory_order_relaxed);
+    while (valor < actual &&
+           !minimo.compare_exchange_weak(actual, valor, std::memory_order_relaxed)) {
+    }
+}
+
+// Recorre el prefijo de la tarea y luego el subárbol que cuelga de él.
+static bool resolverTarea(EstadoDFS& estado, int nivelesPrefijo, long long tarea) {
+    long long resto = tarea;
+    int ops[MAX_PASOS];
+    for (int nivel = nivelesPrefijo - 1; nivel >= 0; --nivel) {
+        ops[nivel] = static_cast<int>(resto % estado.numOps);
+        resto /= estado.numOps;
+    }
+    for (int nivel = 0; nivel < nivelesPrefijo; ++nivel) {
+        if (!avanzarNivel(estado, nivel, ops[nivel])) return false;
+    }
+    return explorar(estado, nivelesPrefijo);
+}
+
+static void trabajador(BusquedaParalela& b, int id) {
+    Transformation* secuencia = b.secuencias[id];
+    EstadoDFS estado;
+    iniciarEstado(estado, *b.ventana, b.mask, b.maskingDataArray, b.profundidad, secuencia);
+    estado.mejorTarea = &b.mejorTarea;
+
+    for (;;) {
+        long long tarea = tomarTarea(b.rangos[id]);
+        if (tarea < 0) {
+            bool robado = false;
+            for (int k = 1; k < b.numHilos && !robado; ++k) {
+                robado = robarTareas(b.rangos[(id + k) % b.numHilos], b.rangos[id]);
+            }
+            if (!robado) break;
+            continue;
+        }
+        if (tarea > b.mejorTarea.load(std::memory_order_relaxed)) continue;
+
+        estado.tareaActual = tarea;
+        bool resuelta = resolverTarea(estado, b.nivelesPrefijo,
+                                      b.primeraTarea + tarea * b.pasoTareas);
+        if (b.tareasHechas) b.tareasHechas->fetch_add(1, std::memory_order_relaxed);
+        if (resuelta) {
+            b.tareaEncontrada[id] = tarea;
+            actualizarMinimo(b.mejorTarea, tarea);
+            // Las tareas que quedan en el rango propio son posteriores
+            b.rangos[id].rango.store(0, std::memory_order_release);
+            break;
+        }
+    }
+    liberarEstado(estado);
+}
+
+// ==============================================
+// HILOS DE LA BÚSQUEDA
+// ==============================================
+// Los trabajadores 1 .. N-1 de buscarEnTareas corren en hilos que no
+// terminan, así que sus arenas (y las páginas ya tocadas) se conservan entre
+// búsquedas. Cada búsqueda se queda con los hilos que necesita mientras dura:
+// varias búsquedas a la vez (lote, servidor, biblioteca) no se esperan entre
+// sí, y solo se crean hilos cuando se piden más trabajadores a la vez que
+// nunca antes.
+
+struct EncargoBusqueda {
+    BusquedaParalela* busqueda;
+    int id;
+};
+
+class HilosBusqueda {
+public:
+    // Lanza los trabajadores [desde, hasta) de 'b'; cada uno descuenta
+    // b.pendientes al terminar
+    void encargar(BusquedaParalela& b, int desde, int hasta) {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        // Lo que puede fallar va antes de tocar la cuenta de hilos libres
+        encargos.reserve(encargos.size() + (hasta - desde));
+        int faltan = (hasta - desde) - libres;
+        for (int h = 0; h < faltan; ++h) {
+            std::thread(&HilosBusqueda::atender, this).detach();
+            ++libres;
+        }
+        libres -= hasta - desde;
+        for (int id = desde; id < hasta; ++id) encargos.push_back({&b, id});
+        hayEncargos.notify_all();
+    }
+
+private:
+    void atender() {
+        for (;;) {
+            EncargoBusqueda encargo;
+            {
+                std::unique_lock<std::mutex> bloqueo(mutex);
+                hayEncargos.wait(bloqueo, [this] { return !encargos.empty(); });
+                encargo = encargos.back();
+                encargos.pop_back();
+            }
+            BusquedaParalela& b = *encargo.busqueda;
+            trabajador(b, encargo.id);
+            {
+                // Después de esto 'b' puede dejar de existir
+                std::lock_guard<std::mutex> bloqueo(b.mutexFin);
+                if (--b.pendientes == 0) b.fin.notify_one();
+            }
+            std::lock_guard<std::mutex> bloqueo(mutex);
+            ++libres;
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable hayEncargos;
+    std::vector<EncargoBusqueda> encargos;   // conserva su capacidad
+    int libres = 0;                          // hilos sin búsqueda asignada
+};
+
+// No se destruye nunca: sus hilos siguen esperando encargos hasta que
+// termina el proceso
+static HilosBusqueda& hilosBusqueda() {
+    static HilosBusqueda* hilos = new HilosBusqueda;
+    return *hilos;
+}
+
+// Reparte entre los hilos las tareas locales 0 .. numTareas-1 (ver
+// BusquedaParalela). Devuelve el índice local de la primera con solución en
+// orden serial, dejando su secuencia en 'secuencia', o -1 si no hay ninguna.
+static long long buscarEnTareas(VentanaDispersa& ventana, unsigned char* mask,
+                                unsigned char** maskingDataArray, int profundidad,
+                                int nivelesPrefijo, long long numTareas,
+                                long long primeraTarea, long long pasoTareas, int numHilos,
+                                std::atomic<long long>* tareasHechas,
+                                Transformation* secuencia) {
+    BusquedaParalela b;
+    b.ventana = &ventana;
+    b.mask = mask;
+    b.maskingDataArray = maskingDataArray;
+    b.profundidad = profundidad;
+    b.nivelesPrefijo = nivelesPrefijo;
+    b.primeraTarea = primeraTarea;
+    b.pasoTareas = pasoTareas;
+    b.tareasHechas = tareasHechas;
+    b.numHilos = numHilos;
+    b.mejorTarea.store(LLONG_MAX);
+    b.pendientes = numHilos - 1;
+
+    // Las tablas por hilo salen de la arena del que llama
+    ArenaTemporal& arena = arenaDelHilo();
+    AmbitoArena ambito(arena);
+    b.rangos = reinterpret_cast<RangoTareas*>(arena.reservar(sizeof(RangoTareas) * numHilos));
+    b.tareaEncontrada =
+        reinterpret_cast<long long*>(arena.reservar(sizeof(long long) * numHilos));
+    b.secuencias = reinterpret_cast<Transformation(*)[MAX_PASOS]>(
+        arena.reservar(sizeof(Transformation[MAX_PASOS]) * numHilos));
+
+    for (int h = 0; h < numHilos; ++h) {
+        uint32_t inicio = static_cast<uint32_t>(numTareas * h / numHilos);
+        uint32_t fin = static_cast<uint32_t>(numTareas * (h + 1) / numHilos);
+        new (&b.rangos[h]) RangoTareas;
+        b.rangos[h].rango.store(empaquetarRango(inicio, fin));
+        b.tareaEncontrada[h] = -1;
+    }
+
+    // El hilo que llama hace de trabajador 0. Aunque falle, 'b' tiene que
+    // seguir viva hasta que terminen los demás.
+    if (numHilos > 1) hilosBusqueda().encargar(b, 1, numHilos);
+    auto esperarTrabajadores = [&b] {
+        std::unique_lock<std::mutex> bloqueo(b.mutexFin);
+        b.fin.wait(bloqueo, [&b] { return b.pendientes == 0; });
+    };
+    try {
+        trabajador(b, 0);
+    } catch (...) {
+        b.mejorTarea.store(-1);   // los demás abandonan sus tareas
+        esperarTrabajadores();
+        throw;
+    }
+    esperarTrabajadores();
+
+    long long mejor = b.mejorTarea.load();
+    long long encontrada = -1;
+    for (int h = 0; h < numHilos; ++h) {
+        if (b.tareaEncontrada[h] == mejor && mejor != LLONG_MAX) {
+            for (int i = 0; i < profundidad; ++i) secuencia[i] = b.secuencias[h][i];
+            encontrada = mejor;
+        }
+    }
+
+    return encontrada;
+}
+
+static int hilosEfectivos(int numHilos) {
+    if (numHilos <= 0) numHilos = static_cast<int>(std::thread::hardware_concurrency());
+    return numHilos > 0 ? numHilos : 1;
+}
+
+bool buscarSecuenciaParalela(VentanaDispersa& ventana, unsigned char* mask,
+                             unsigned char** maskingDataArray, int profundidad,
+                             int numHilos, Transformation* secuencia) {
+    numHilos = hilosEfectivos(numHilos);
+    if (numHilos == 1) {
+        return buscarSecuenciaDFS(ventana, mask, maskingDataArray, profundidad, secuencia);
+    }
+    if (profundidad < 1 || profundidad > MAX_PASOS) return false;
+
+    // Suficientes prefijos para repartir: al menos 8 tareas por hilo
+    Transformation catalogo[NUM_TRANSFORMACIONES];
+    int numOps;
+    generarCatalogoCanonico(catalogo, numOps);
+    int nivelesPrefijo = 1;
+    long long numTareas = numOps;
+    while (nivelesPrefijo < profundidad && numTareas < 8LL * numHilos) {
+        ++nivelesPrefijo;
+        numTareas *= numOps;
+    }
+
+    return buscarEnTareas(ventana, mask, maskingDataArray, profundidad, nivelesPrefijo,
+                          numTareas, 0, 1, numHilos, nullptr, secuencia) >= 0;
+}
+
+// ==============================================
+// BÚSQUEDA POR FRAGMENTOS
+// ==============================================
+
+int nivelesFragmentos(int profundidad, int numFragmentos, long long& numTareas) {
+    Transformation catalogo[NUM_TRANSFORMACIONES];
+    int numOps;
+    generarCatalogoCanonico(catalogo, numOps);
+    int niveles = 1;
+    numTareas = numOps;
+    while (niveles < profundidad && numTareas < 64LL * numFragmentos) {
+        ++niveles;
+        numTareas *= numOps;
+    }
+    return niveles;
+}
+
+long long tareasDelFragmento(int profundidad, int indice, int numFragmentos) {
+    long long numTareas;
+    nivelesFragmentos(profundidad, numFragmentos, numTareas);
+    return indice < numTareas ? (numTareas - indice + numFragmentos - 1) / numFragmentos : 0;
+}
+
+// Secuencia del ejemplo que buscarSecuencia prueba antes que todo
+static bool probarSecuenciaConocida(VentanaDispersa& ventana, unsigned char* mask,
+                                    unsigned char** maskingDataArray, int profundidad,
+                                    Transformation* secuencia) {
+    Transformation knownSequence[] = {
+        {XOR_OP, 0},
+        {ROTATE_RIGHT_OP, 3},
+        {XOR_OP, 0}
+    };
+    if (profundidad == 3 && verificarPorEtapas(ventana, mask, maskingDataArray,
+                                               knownSequence, profundidad)) {
+        for (int i = 0; i < profundidad; ++i) secuencia[i] = knownSequence[i];
+        return true;
+    }
+    return false;
+}
+
+bool buscarFragmento(VentanaDispersa& ventana, unsigned char* mask,
+                     unsigned char** maskingDataArray, int profundidad, int indice,
+                     int numFragmentos, int numHilos, Transformation* secuencia,
+                     long long& tarea, std::atomic<long long>* tareasHechas) {
+    MedicionFase medicion(FASE_BUSQUEDA);
+    tarea = -1;
+    if (profundidad < 1 || profundidad > MAX_PASOS) return false;
+    if (probarSecuenciaConocida(ventana, mask, maskingDataArray, profundidad, secuencia)) {
+        return true;
+    }
+
+    long long numTareas;
+    int niveles = nivelesFragmentos(profundidad, numFragmentos, numTareas);
+    long long propias = tareasDelFragmento(profundidad, indice, numFragmentos);
+    if (propias == 0) return false;
+    numHilos = hilosEfectivos(numHilos);
+    if (numHilos > propias) numHilos = static_cast<int>(propias);
+    long long local = buscarEnTareas(ventana, mask, maskingDataArray, profundidad, niveles,
+                                     propias, indice, numFragmentos, numHilos, tareasHechas,
+                                     secuencia);
+    if (local < 0) return false;
+    tarea = indice + local * numFragmentos;
+    return true;
+}
+
+// ==============================================
+// RECONSTRUCCIÓN DE IMAGEN
+// ==============================================
+
+//Verifica si una secuencia específica de transformaciones (en orden inverso)
+// - puede reconstruir correctamente la imagen original.
+//Comprueba, etapa por etapa, que cada imagen intermedia coincide con los datos
+// - de enmascaramiento guardados en su archivo. El candidato tiene
+// - numTransformations + 1 transformaciones.
+
+bool testTransformations(unsigned char* finalImage, unsigned char* IM,
+                         unsigned char* mask, int width, int height,
+                         int maskWidth, int maskHeight,
+                         unsigned char** maskingDataArray, int* seeds,
+                         int numTransformations,
+                         const Transformation* candidateTransformations) {
+    VentanaDispersa ventana;
+    crearVentanaDispersa(ventana, finalImage, IM, static_cast<size_t>(width) * height * 3, seeds,
+                         numTransformations, maskWidth * maskHeight * 3);
+
+    bool valid = verificarPorEtapas(ventana, mask, maskingDataArray,
+                                    candidateTransformations, numTransformations + 1);
+
+    liberarVentanaDispersa(ventana);
+    return valid;
+}
+
+bool buscarSecuencia(VentanaDispersa& ventana, unsigned char* mask,
+                     unsigned char** maskingDataArray, int numTransformations,
+                     const OpcionesBusqueda& opciones, Transformation* secuencia) {
+    MedicionFase medicion(FASE_BUSQUEDA);
+    int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+
+    // Primero probamos la secuencia conocida del ejemplo
+    if (probarSecuenciaConocida(ventana, mask, maskingDataArray, profundidad, secuencia)) {
+        return true;
+    }
+
+    // Si no funciona, solución por etapas o búsqueda en profundidad con poda
+    if (opciones.analitico) {
+        return resolverPorEtapas(ventana, mask, maskingDataArray, profundidad,
+                                 secuencia, nullptr);
+    }
+    return buscarSecuenciaParalela(ventana, mask, maskingDataArray, profundidad,
+                                   opciones.numHilos, secuencia);
+}
+
+bool buscarSecuenciaConCache(VentanaDispersa& ventana, unsigned char* mask,
+                             unsigned char** maskingDataArray, int numTransformations,
+                             const OpcionesBusqueda& opciones, Transformation* secuencia) {
+    if (!opciones.cacheSecuencias) {
+        return buscarSecuencia(ventana, mask, maskingDataArray, numTransformations, opciones,
+                               secuencia);
+    }
+
+    int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+    uint64_t clave = claveSecuencia(ventana, mask, maskingDataArray, profundidad);
+    bool valida = leerSecuenciaCacheada(opciones.cacheSecuencias, clave, secuencia, profundidad);
+    contarPerfil(valida ? CONTADOR_CACHE_ACIERTOS : CONTADOR_CACHE_FALLOS, 1);
+    if (valida && opciones.verificarCache &&
+        !verificarPorEtapas(ventana, mask, maskingDataArray, secuencia, profundidad)) {
+        contarPerfil(CONTADOR_CACHE_INVALIDAS, 1);
+        valida = false;
+    }
+    if (valida) return true;
+
+    if (!buscarSecuencia(ventana, mask, maskingDataArray, numTransformations, opciones,
+                         secuencia)) {
+        return false;
+    }
+    guardarSecuenciaCacheada(opciones.cacheSecuencias, clave, secuencia, profundidad);
+    return true;
+}
+
+unsigned char* reconstructImage(unsigned char* finalImage, unsigned char* IM,
+                                unsigned char* mask, int width, int height,
+                                int maskWidth, int maskHeight,
+                                unsigned char** maskingDataArray, int* seeds,
+                                int numTransformations,
+                                Transformation* secuencia,
+                                const OpcionesBusqueda& opciones) {
+    // Los candidatos se evalúan sobre la ventana dispersa; la imagen completa
+    // solo se recorre una vez, para la secuencia ganadora.
+    VentanaDispersa ventana;
+    crearVentanaDispersa(ventana, finalImage, IM, static_cast<size_t>(width) * height * 3, seeds,
+                         numTransformations, maskWidth * maskHeight * 3);
+
+    int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+    Transformation encontrada[MAX_PASOS];
+    bool valida = buscarSecuenciaConCache(ventana, mask, maskingDataArray, numTransformations,
+                                          opciones, encontrada);
+    liberarVentanaDispersa(ventana);
+
+    if (!valida) return nullptr;
+    if (secuencia) {
+        for (int i = 0; i < profundidad; ++i) secuencia[i] = encontrada[i];
+    }
+    return applyInverseTransformations(finalImage, IM, encontrada, profundidad,
+                                       width, height);
+}
@@ -0,0 +1,136 @@
+#ifndef BUSQUEDA_H
+#define BUSQUEDA_H
+
+#include <atomic>
+
+#include "enmascaramiento.h"
+#include "transformaciones.h"
+
+// ==============================================
+// BÚSQUEDA DE LA SECUENCIA DE TRANSFORMACIONES
+// ==============================================
+// Modelo por etapas: la imagen original P0 pasa por las transformaciones
+// T[0..profundidad-1]; Ps es la imagen tras aplicar T[s-1] y I_D es la última.
+// El archivo M<s>.txt (maskingDataArray[s-1], seeds[s-1]) guarda el
+// enmascaramiento de Ps, así que con numTransformations archivos la
+// profundidad es numTransformations + 1.
+//
+// Al deshacer desde I_D, cada etapa que produce un Ps con archivo se verifica
+// en cuanto se obtiene, y si falla se descarta todo el subárbol.
+//
+// Orden serial: las secuencias se recorren en orden lexicográfico según el
+// orden en que se deshacen (primero T[profundidad-1], al final T[0]), y
+// dentro de cada etapa en el orden de generatePossibleTransformations.
+//
+// Solo se enumeran secuencias canónicas (ver generarCatalogoCanonico y
+// admiteCanonico): de cada grupo de secuencias equivalentes se prueba una
+// sola, la primera en orden serial.
+
+struct OpcionesBusqueda {
+    int numHilos = 1;      // 0 = un hilo por núcleo
+    int profundidad = 0;   // 0 = numTransformations + 1
+    bool analitico = false; // resolverPorEtapas en lugar de la búsqueda
+    // Caché de secuencias de reconstructImage (ver cache_secuencias.h):
+    // directorio o nullptr para no usarla, y si se comprueba cada acierto
+    // contra los enmascaramientos antes de usarlo
+    const char* cacheSecuencias = nullptr;
+    bool verificarCache = false;
+};
+
+// Número de secuencias canónicas de la profundidad dada (antes de podar por
+// enmascaramiento).
+long long contarSecuenciasCanonicas(int profundidad, int numSemillas);
+
+// Comprueba un candidato completo etapa por etapa sobre la ventana dispersa.
+bool verificarPorEtapas(VentanaDispersa& ventana, unsigned char* mask,
+                        unsigned char** maskingDataArray,
+                        const Transformation* candidato, int profundidad);
+
+// Búsqueda en profundidad con un buffer por nivel (el resultado de cada
+// prefijo se calcula una sola vez). Deja en 'secuencia' la primera secuencia
+// válida en orden serial y devuelve false si no hay ninguna.
+bool buscarSecuenciaDFS(VentanaDispersa& ventana, unsigned char* mask,
+                        unsigned char** maskingDataArray, int profundidad,
+                        Transformation* secuencia);
+
+// Igual que buscarSecuenciaDFS pero repartiendo los prefijos entre hilos con
+// robo de trabajo. Cada hilo tiene sus propios buffers y la búsqueda termina
+// en cuanto se sabe cuál es la primera secuencia válida en orden serial, así
+// que el resultado es el mismo que con un solo hilo.
+bool buscarSecuenciaParalela(VentanaDispersa& ventana, unsigned char* mask,
+                             unsigned char** maskingDataArray, int profundidad,
+                             int numHilos, Transformation* secuencia);
+
+// ==============================================
+// BÚSQUEDA POR FRAGMENTOS
+// ==============================================
+// Reparto determinista de una búsqueda profunda entre procesos o máquinas.
+// Las tareas son los prefijos de los primeros niveles, numerados en orden
+// serial; cuántos niveles depende solo de la profundidad y del número de
+// fragmentos, así que todos los procesos ven la misma numeración. El
+// fragmento i (0 .. numFragmentos-1) se queda con las tareas i,
+// i + numFragmentos, i + 2*numFragmentos, ...: intercaladas, las zonas del
+// árbol que se podan pronto y las que no se reparten por igual.
+
+// Niveles de cada tarea; 'numTareas' recibe cuántas hay en total.
+int nivelesFragmentos(int profundidad, int numFragmentos, long long& numTareas);
+
+// Cuántas de esas tareas le tocan al fragmento 'indice'
+long long tareasDelFragmento(int profundidad, int indice, int numFragmentos);
+
+// Busca en las tareas del fragmento con 'numHilos' hilos (0 = uno por
+// núcleo). Si encuentra una secuencia deja en 'tarea' la primera en orden
+// serial (-1 para la secuencia conocida del ejemplo, que buscarSecuencia
+// prueba antes que todo). La de menor 'tarea' entre todos los fragmentos es
+// la que devolvería buscarSecuencia. 'tareasHechas', si no es nulo, se
+// incrementa con cada tarea terminada.
+bool buscarFragmento(VentanaDispersa& ventana, unsigned char* mask,
+                     unsigned char** maskingDataArray, int profundidad, int indice,
+                     int numFragmentos, int numHilos, Transformation* secuencia,
+                     long long& tarea, std::atomic<long long>* tareasHechas);
+
+// Deduce cada transformación directamente de los datos de enmascaramiento:
+// en cada etapa con archivo, los bytes esperados de Ps son
+// maskingData[k] - mask[k], y solo una transformación del catálogo debería
+// producirlos. Cuesta O(maskSize * transformaciones) por etapa, sin importar
+// la profundidad. Desde la primera etapa ambigua (o sin archivo) continúa con
+// la búsqueda en profundidad; 'etapasAmbiguas' (si no es nulo) recibe cuántas
+// etapas quedaron para ella. El resultado es el mismo que buscarSecuenciaDFS.
+bool resolverPorEtapas(VentanaDispersa& ventana, unsigned char* mask,
+                       unsigned char** maskingDataArray, int profundidad,
+                       Transformation* secuencia, int* etapasAmbiguas);
+
+bool testTransformations(unsigned char* finalImage, unsigned char* IM,
+                         unsigned char* mask, int width, int height,
+                         int maskWidth, int maskHeight,
+                         unsigned char** maskingDataArray, int* seeds,
+                         int numTransformations,
+                         const Transformation* candidateTransformations);
+
+// Elige la secuencia para reconstructImage a partir de una ventana ya
+// construida: la secuencia conocida del ejemplo y luego la solución por
+// etapas o la búsqueda en profundidad según 'opciones'.
+bool buscarSecuencia(VentanaDispersa& ventana, unsigned char* mask,
+                     unsigned char** maskingDataArray, int numTransformations,
+                     const OpcionesBusqueda& opciones, Transformation* secuencia);
+
+// buscarSecuencia a través de la caché de secuencias (si
+// opciones.cacheSecuencias no es nulo): la toma de ella si ya se resolvió la
+// misma ventana y la guarda si hubo que buscarla.
+bool buscarSecuenciaConCache(VentanaDispersa& ventana, unsigned char* mask,
+                             unsigned char** maskingDataArray, int numTransformations,
+                             const OpcionesBusqueda& opciones, Transformation* secuencia);
+
+// Devuelve la imagen reconstruida y, si 'secuencia' no es nulo, deja en ella
+// las transformaciones encontradas (opciones.profundidad, o
+// numTransformations + 1 si es 0). La secuencia sale de
+// buscarSecuenciaConCache.
+unsigned char* reconstructImage(unsigned char* finalImage, unsigned char* IM,
+                                unsigned char* mask, int width, int height,
+                                int maskWidth, int maskHeight,
+                                unsigned char** maskingDataArray, int* seeds,
+                                int numTransformations,
+                                Transformation* secuencia = nullptr,
+                                const OpcionesBusqueda& opciones = OpcionesBusqueda());
+
+#endif // BUSQUEDA_H
@@ -0,0 +1,63 @@
+#include "cache_imagenes.h"
+
+#include <QString>
+#include <system_error>
+#include <utility>
+
+#include "imagenes.h"
+
+std::shared_ptr<const ImagenCacheada> CacheImagenes::obtener(const std::string& ruta) {
+    std::error_code error;
+    std::filesystem::file_time_type fecha = std::filesystem::last_write_time(ruta, error);
+    uintmax_t tamanoArchivo = error ? 0 : std::filesystem::file_size(ruta, error);
+    if (error) return nullptr;
+
+    {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        auto it = indice.find(ruta);
+        if (it != indice.end()) {
+            Entrada& entrada = *it->second;
+            if (entrada.fecha == fecha && entrada.tamanoArchivo == tamanoArchivo) {
+                entradas.splice(entradas.begin(), entradas, it->second);
+                ++aciertos;
+                return entrada.imagen;
+            }
+            // El archivo cambió desde que se cargó
+            bytes -= entrada.imagen->pixeles.tamano();
+            entradas.erase(it->second);
+            indice.erase(it);
+        }
+        ++fallos;
+    }
+
+    // La carga se hace sin el candado; si dos hilos piden a la vez la misma
+    // imagen nueva, ambos la cargan y se queda la primera que llegue.
+    std::shared_ptr<ImagenCacheada> imagen = std::make_shared<ImagenCacheada>();
+    imagen->pixeles = loadPixels(QString::fromStdString(ruta), imagen->width, imagen->height);
+    if (!imagen->pixeles) return nullptr;
+
+    std::lock_guard<std::mutex> bloqueo(mutex);
+    auto it = indice.find(ruta);
+    if (it != indice.end()) return it->second->imagen;
+    entradas.push_front({ruta, fecha, tamanoArchivo, imagen});
+    indice[ruta] = entradas.begin();
+    bytes += imagen->pixeles.tamano();
+    expulsar();
+    return imagen;
+}
+
+// Expulsa las menos usadas hasta caber en la capacidad; la más reciente se
+// conserva aunque sola ya la supere.
+void CacheImagenes::expulsar() {
+    while (bytes > capacidad && entradas.size() > 1) {
+        Entrada& ultima = entradas.back();
+        bytes -= ultima.imagen->pixeles.tamano();
+        indice.erase(ultima.ruta);
+        entradas.pop_back();
+    }
+}
+
+CacheImagenes::Estadisticas CacheImagenes::estadisticas() const {
+    std::lock_guard<std::mutex> bloqueo(mutex);
+    return {aciertos, fallos, bytes, static_cast<int>(entradas.size())};
+}
@@ -0,0 +1,67 @@
+#ifndef CACHE_IMAGENES_H
+#define CACHE_IMAGENES_H
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "memoria.h"
+
+// ==============================================
+// CACHÉ DE IMÁGENES DECODIFICADAS
+// ==============================================
+// Para el modo servidor: I_M.bmp y M.bmp suelen ser los mismos en miles de
+// trabajos, así que se guardan ya decodificadas (RGB888, como loadPixels).
+// La clave es la ruta junto con la fecha de modificación y el tamaño del
+// archivo: si el archivo cambia, la entrada vieja se descarta. Cuando se
+// supera la capacidad se expulsan las menos usadas recientemente. Es segura
+// entre hilos.
+
+struct ImagenCacheada {
+    BufferBytes pixeles;
+    int width;
+    int height;
+};
+
+class CacheImagenes {
+public:
+    struct Estadisticas {
+        uint64_t aciertos;
+        uint64_t fallos;
+        size_t bytes;
+        int entradas;
+    };
+
+    explicit CacheImagenes(size_t capacidadBytes) : capacidad(capacidadBytes) {}
+
+    // Imagen de 'ruta', de la caché si el archivo no cambió. Devuelve nullptr
+    // si no se pudo cargar. El puntero sigue siendo válido aunque la entrada
+    // se expulse mientras se usa.
+    std::shared_ptr<const ImagenCacheada> obtener(const std::string& ruta);
+
+    Estadisticas estadisticas() const;
+
+private:
+    struct Entrada {
+        std::string ruta;
+        std::filesystem::file_time_type fecha;
+        uintmax_t tamanoArchivo;
+        std::shared_ptr<const ImagenCacheada> imagen;
+    };
+
+    void expulsar();
+
+    mutable std::mutex mutex;
+    std::list<Entrada> entradas;   // la más reciente al principio
+    std::unordered_map<std::string, std::list<Entrada>::iterator> indice;
+    size_t capacidad;
+    size_t bytes = 0;
+    uint64_t aciertos = 0;
+    uint64_t fallos = 0;
+};
+
+#endif // CACHE_IMAGENES_H
@@ -0,0 +1,88 @@
+#include "cache_secuencias.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "codificacion.h"
+#include "hash_rapido.h"
+
+static std::string rutaEntrada(const char* directorio, uint64_t clave) {
+    char nombre[17];
+    snprintf(nombre, sizeof(nombre), "%016llx", static_cast<unsigned long long>(clave));
+    return (std::filesystem::path(directorio) / nombre).string();
+}
+
+uint64_t claveSecuencia(const VentanaDispersa& ventana, const unsigned char* mask,
+                        unsigned char** maskingDataArray, int profundidad) {
+    // Los tamaños van delante para que dos casos distintos no puedan dar la
+    // misma secuencia de bytes
+    uint64_t cabecera[5] = {static_cast<uint64_t>(VERSION_OPERACIONES),
+                            static_cast<uint64_t>(NUM_TRANSFORMACIONES),
+                            static_cast<uint64_t>(ventana.numSemillas),
+                            static_cast<uint64_t>(ventana.maskSize),
+                            static_cast<uint64_t>(profundidad)};
+    size_t tamanoVentana = static_cast<size_t>(ventana.numSemillas) * ventana.maskSize;
+    EstadoXXH64 estado;
+    iniciarXXH64(estado);
+    actualizarXXH64(estado, cabecera, sizeof(cabecera));
+    actualizarXXH64(estado, mask, ventana.maskSize);
+    for (int i = 0; i < ventana.numSemillas; ++i) {
+        actualizarXXH64(estado, maskingDataArray[i], ventana.maskSize);
+    }
+    actualizarXXH64(estado, ventana.imagen, tamanoVentana);
+    actualizarXXH64(estado, ventana.IM, tamanoVentana);
+    return finalizarXXH64(estado);
+}
+
+bool leerSecuenciaCacheada(const char* directorio, uint64_t clave,
+                           Transformation* secuencia, int profundidad) {
+    FILE* archivo = fopen(rutaEntrada(directorio, clave).c_str(), "r");
+    if (!archivo) return false;
+    char texto[MAX_PASOS * 4 + 2];
+    bool leido = fgets(texto, sizeof(texto), archivo) != nullptr;
+    fclose(archivo);
+    if (!leido) return false;
+
+    std::string linea(texto);
+    while (!linea.empty() && (linea.back() == '\n' || linea.back() == '\r')) linea.pop_back();
+    Transformation leida[MAX_PASOS];
+    if (leerSecuencia(linea.c_str(), leida) != profundidad) return false;
+    for (int i = 0; i < profundidad; ++i) secuencia[i] = leida[i];
+    return true;
+}
+
+bool guardarSecuenciaCacheada(const char* directorio, uint64_t clave,
+                              const Transformation* secuencia, int profundidad) {
+    std::error_code error;
+    std::filesystem::create_directories(directorio, error);
+    if (error) return false;
+
+    char texto[MAX_PASOS * 4 + 1];
+    escribirSecuencia(secuencia, profundidad, texto, sizeof(texto));
+
+    // El temporal lleva algo propio del hilo para que dos escrituras de la
+    // misma clave no se pisen
+    std::string ruta = rutaEntrada(directorio, clave);
+    std::string temporal =
+        ruta + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                       static_cast<size_t>(
+                           std::chrono::steady_clock::now().time_since_epoch().count())) +
+        ".tmp";
+    FILE* archivo = fopen(temporal.c_str(), "w");
+    if (!archivo) return false;
+    bool ok = fprintf(archivo, "%s\n", texto) > 0;
+    ok = fclose(archivo) == 0 && ok;
+
+    if (ok) std::filesystem::rename(temporal, ruta, error);
+    if (!ok || error) {
+        std::filesystem::remove(temporal, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef CACHE_SECUENCIAS_H
+#define CACHE_SECUENCIAS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "enmascaramiento.h"
+#include "transformaciones.h"
+
+// ==============================================
+// CACHÉ DE SECUENCIAS RESUELTAS
+// ==============================================
+// Guarda en disco la secuencia ganadora de cada caso, direccionada por
+// contenido: la clave es un XXH64 de todo lo que mira la búsqueda (la
+// ventana dispersa de I_D e I_M, M y los enmascaramientos), de la
+// profundidad y de VERSION_OPERACIONES. Volver a procesar las mismas
+// entradas, aunque estén en otro directorio, evita la búsqueda y deja solo
+// una pasada de applyInverseTransformations. Como la clave no necesita las
+// imágenes completas, se puede calcular antes de que terminen de cargarse.
+//
+// Cada entrada es un archivo de texto con el nombre de la clave en
+// hexadecimal y la secuencia en el formato de escribirSecuencia
+// ("X,R3,L2"), así que se puede inspeccionar o borrar a mano.
+
+// Directorio por defecto, relativo al directorio de trabajo
+const char* const DIRECTORIO_CACHE_SECUENCIAS = "cache_secuencias";
+
+uint64_t claveSecuencia(const VentanaDispersa& ventana, const unsigned char* mask,
+                        unsigned char** maskingDataArray, int profundidad);
+
+// Deja en 'secuencia' la entrada de 'clave' si existe y tiene exactamente
+// 'profundidad' transformaciones.
+bool leerSecuenciaCacheada(const char* directorio, uint64_t clave,
+                           Transformation* secuencia, int profundidad);
+
+// Crea el directorio si hace falta. La entrada se escribe a un temporal y se
+// renombra, así que varios procesos pueden compartir la caché.
+bool guardarSecuenciaCacheada(const char* directorio, uint64_t clave,
+                              const Transformation* secuencia, int profundidad);
+
+#endif // CACHE_SECUENCIAS_H
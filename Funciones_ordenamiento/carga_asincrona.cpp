@@ -0,0 +1,120 @@
+#include "carga_asincrona.h"
+
+#include <QString>
+
+#include "carga_datos.h"
+#include "imagen_bmp.h"
+#include "imagenes.h"
+#include "reconstruccion_bandas.h"
+
+static std::string rutaEnCaso(const std::string& directorio, const char* nombre) {
+    return directorio.empty() ? std::string(nombre) : directorio + "/" + nombre;
+}
+
+static ImagenCargada cargarImagen(std::string ruta) {
+    ImagenCargada imagen;
+    imagen.pixeles = loadPixels(QString::fromStdString(ruta), imagen.width, imagen.height);
+    return imagen;
+}
+
+static EnmascaramientoCargado cargarEnmascaramiento(std::string ruta) {
+    EnmascaramientoCargado cargado;
+    cargado.datos = loadSeedMasking(ruta.c_str(), cargado.seed, cargado.n_pixels);
+    return cargado;
+}
+
+void iniciarCargaAsincrona(CargaAsincrona& carga, const char* directorio,
+                           int numTransformations, bool imagenesCompletas) {
+    carga.directorio = directorio;
+    // Primero lo que hace falta para empezar a buscar
+    carga.futuroMascara = std::async(std::launch::async, cargarImagen,
+                                     rutaEnCaso(carga.directorio, "M.bmp"));
+    carga.futurosEnmascaramiento.clear();
+    for (int i = 0; i < numTransformations; ++i) {
+        char ruta[1024];
+        rutaEnmascaramiento(directorio, i + 1, ruta, sizeof(ruta));
+        carga.futurosEnmascaramiento.push_back(
+            std::async(std::launch::async, cargarEnmascaramiento, std::string(ruta)));
+    }
+    if (imagenesCompletas) {
+        carga.futuroFinal = std::async(std::launch::async, cargarImagen,
+                                       rutaEnCaso(carga.directorio, "I_D.bmp"));
+        carga.futuroIM = std::async(std::launch::async, cargarImagen,
+                                    rutaEnCaso(carga.directorio, "I_M.bmp"));
+    }
+}
+
+bool esperarEnmascaramiento(CargaAsincrona& carga, ImagenCargada& mask,
+                            std::vector<BufferBytes>& datos, std::vector<int>& seeds,
+                            std::string& error) {
+    mask = carga.futuroMascara.get();
+    if (!mask.pixeles) {
+        error = "Error al cargar: " + rutaEnCaso(carga.directorio, "M.bmp");
+        return false;
+    }
+    datos.clear();
+    seeds.clear();
+    std::vector<int> pixeles;
+    for (size_t i = 0; i < carga.futurosEnmascaramiento.size(); ++i) {
+        EnmascaramientoCargado cargado = carga.futurosEnmascaramiento[i].get();
+        if (!cargado.datos) {
+            char ruta[1024];
+            rutaEnmascaramiento(carga.directorio.c_str(), static_cast<int>(i) + 1, ruta,
+                                sizeof(ruta));
+            error = std::string("Error al cargar archivo de enmascaramiento: ") + ruta;
+            return false;
+        }
+        datos.push_back(std::move(cargado.datos));
+        seeds.push_back(cargado.seed);
+        pixeles.push_back(cargado.n_pixels);
+    }
+    return comprobarEnmascaramientos(pixeles, static_cast<size_t>(mask.width) * mask.height * 3,
+                                     error);
+}
+
+bool esperarImagenes(CargaAsincrona& carga, std::string& error) {
+    if (!carga.imagenesListas) {
+        carga.finalImage = carga.futuroFinal.valid()
+                               ? carga.futuroFinal.get()
+                               : cargarImagen(rutaEnCaso(carga.directorio, "I_D.bmp"));
+        carga.IM = carga.futuroIM.valid() ? carga.futuroIM.get()
+                                          : cargarImagen(rutaEnCaso(carga.directorio, "I_M.bmp"));
+        carga.imagenesListas = true;
+    }
+    if (!carga.finalImage.pixeles || !carga.IM.pixeles) {
+        error = "Error al cargar: " +
+                rutaEnCaso(carga.directorio, carga.finalImage.pixeles ? "I_M.bmp" : "I_D.bmp");
+        return false;
+    }
+    if (carga.finalImage.width != carga.IM.width || carga.finalImage.height != carga.IM.height) {
+        error = "I_D.bmp e I_M.bmp no tienen el mismo tamaño";
+        return false;
+    }
+    return true;
+}
+
+bool crearVentanaAnticipada(CargaAsincrona& carga, const int* seeds, int numSemillas,
+                            int maskSize, VentanaDispersa& ventana, std::string& error) {
+    if (!carga.imagenesListas) {
+        VistaBMP imagen, IM;
+        bool abiertas = abrirBMP(imagen, rutaEnCaso(carga.directorio, "I_D.bmp").c_str());
+        if (abiertas && !abrirBMP(IM, rutaEnCaso(carga.directorio, "I_M.bmp").c_str())) {
+            cerrarBMP(imagen);
+            abiertas = false;
+        }
+        if (abiertas) {
+            bool creada = crearVentanaDesdeBMP(ventana, imagen, IM, seeds, numSemillas, maskSize);
+            cerrarBMP(imagen);
+            cerrarBMP(IM);
+            if (!creada) error = "I_D.bmp e I_M.bmp no tienen el mismo tamaño";
+            return creada;
+        }
+    }
+
+    // Otro formato: hace falta la imagen decodificada
+    if (!esperarImagenes(carga, error)) return false;
+    crearVentanaDispersa(ventana, carga.finalImage.pixeles.datos(), carga.IM.pixeles.datos(),
+                         static_cast<size_t>(carga.finalImage.width) * carga.finalImage.height * 3,
+                         seeds, numSemillas, maskSize);
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef CARGA_ASINCRONA_H
+#define CARGA_ASINCRONA_H
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "enmascaramiento.h"
+#include "memoria.h"
+
+// ==============================================
+// CARGA ASÍNCRONA DE UN CASO
+// ==============================================
+// Lanza a la vez la lectura de I_D.bmp, I_M.bmp, M.bmp y de cada M<i>.txt,
+// cada una en su propio hilo, y deja que la búsqueda empiece en cuanto está
+// lo que necesita la primera verificación: M, los enmascaramientos y los
+// bytes de la ventana dispersa. Esos bytes se toman de los BMP mapeados, así
+// que solo se leen sus páginas; I_D e I_M completas siguen cargándose
+// mientras se busca y solo se esperan para la inversa final.
+
+struct ImagenCargada {
+    BufferBytes pixeles;
+    int width = 0;
+    int height = 0;
+};
+
+struct EnmascaramientoCargado {
+    BufferBytes datos;
+    int seed = 0;
+    int n_pixels = 0;
+};
+
+struct CargaAsincrona {
+    std::string directorio;
+    std::future<ImagenCargada> futuroFinal, futuroIM, futuroMascara;
+    std::vector<std::future<EnmascaramientoCargado>> futurosEnmascaramiento;
+    ImagenCargada finalImage, IM;   // ya esperadas
+    bool imagenesListas = false;
+};
+
+// Lanza las lecturas de 'directorio' ("" = el directorio actual). Con
+// 'imagenesCompletas' en false no se cargan I_D ni I_M enteras (por bandas,
+// o si solo hace falta la ventana).
+void iniciarCargaAsincrona(CargaAsincrona& carga, const char* directorio,
+                           int numTransformations, bool imagenesCompletas);
+
+// Espera M.bmp y los enmascaramientos. Devuelve false con el motivo en
+// 'error', también si algún M<i>.txt tiene menos valores de los que pide M.
+bool esperarEnmascaramiento(CargaAsincrona& carga, ImagenCargada& mask,
+                            std::vector<BufferBytes>& datos, std::vector<int>& seeds,
+                            std::string& error);
+
+// Crea la ventana sin esperar a I_D e I_M completas si las dos son BMP de
+// 24 bits; si no, espera su carga (o la hace, si no se lanzó).
+bool crearVentanaAnticipada(CargaAsincrona& carga, const int* seeds, int numSemillas,
+                            int maskSize, VentanaDispersa& ventana, std::string& error);
+
+// Espera I_D e I_M completas y comprueba que tengan el mismo tamaño.
+bool esperarImagenes(CargaAsincrona& carga, std::string& error);
+
+#endif // CARGA_ASINCRONA_H
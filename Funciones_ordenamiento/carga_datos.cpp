@@ -0,0 +1,343 @@
+#include "carga_datos.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "archivo_mapeado.h"
+#include "hash_rapido.h"
+#include "perfilado.h"
+
+// Por encima de este tamaño el archivo se analiza por trozos en paralelo
+static const size_t UMBRAL_PARALELO = 32u * 1024 * 1024;
+static const size_t TAMANO_MINIMO_TROZO = 8u * 1024 * 1024;
+
+// ==============================================
+// ANALIZADOR DE TEXTO
+// ==============================================
+
+struct BufferCreciente {
+    BufferBytes datos;
+    size_t usados;
+};
+
+static void reservarBuffer(BufferCreciente& buffer, size_t capacidad) {
+    buffer.datos = BufferBytes(capacidad > 0 ? capacidad : 1);
+    buffer.usados = 0;
+}
+
+static void agregarValor(BufferCreciente& buffer, unsigned char valor) {
+    if (buffer.usados == buffer.datos.tamano()) {
+        BufferBytes nuevo(buffer.datos.tamano() * 2);
+        memcpy(nuevo.datos(), buffer.datos.datos(), buffer.usados);
+        buffer.datos = std::move(nuevo);
+    }
+    buffer.datos.datos()[buffer.usados++] = valor;
+}
+
+static bool esEspacio(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static const char* saltarEspacios(const char* p, const char* fin) {
+    while (p < fin && esEspacio(*p)) ++p;
+    return p;
+}
+
+// Analiza enteros separados por espacios en [p, fin) y agrega su byte bajo al
+// buffer. Se detiene en el primer token que no sea un entero (igual que
+// 'archivo >> r' en la versión anterior) y lo indica en 'invalido'.
+static void analizarValores(const char* p, const char* fin, BufferCreciente& salida,
+                            bool& invalido) {
+    invalido = false;
+    for (;;) {
+        p = saltarEspacios(p, fin);
+        if (p == fin) return;
+        long valor;
+        std::from_chars_result r = std::from_chars(p, fin, valor);
+        if (r.ec != std::errc() || (r.ptr != fin && !esEspacio(*r.ptr))) {
+            invalido = true;
+            return;
+        }
+        agregarValor(salida, static_cast<unsigned char>(valor));
+        p = r.ptr;
+    }
+}
+
+// ==============================================
+// ANÁLISIS EN PARALELO
+// ==============================================
+
+struct TrozoTexto {
+    const char* inicio;
+    const char* fin;
+    BufferCreciente valores;
+    bool invalido;
+};
+
+static void analizarTrozo(TrozoTexto* trozo) {
+    // Un valor ocupa al menos 2 caracteres con su separador; se empieza con
+    // la mitad de esa cota y el buffer crece si hace falta.
+    reservarBuffer(trozo->valores, static_cast<size_t>(trozo->fin - trozo->inicio) / 4 + 16);
+    analizarValores(trozo->inicio, trozo->fin, trozo->valores, trozo->invalido);
+}
+
+// Analiza [p, fin) repartiéndolo entre hilos. Los cortes se mueven hasta el
+// siguiente espacio para no partir ningún número.
+static BufferCreciente analizarEnParalelo(const char* p, const char* fin) {
+    size_t tamano = static_cast<size_t>(fin - p);
+    int numTrozos = static_cast<int>(std::thread::hardware_concurrency());
+    if (numTrozos <= 1 || tamano < UMBRAL_PARALELO) numTrozos = 1;
+    if (static_cast<size_t>(numTrozos) > tamano / TAMANO_MINIMO_TROZO) {
+        numTrozos = static_cast<int>(tamano / TAMANO_MINIMO_TROZO);
+    }
+    if (numTrozos < 1) numTrozos = 1;
+
+    TrozoTexto* trozos = new TrozoTexto[numTrozos];
+    const char* inicio = p;
+    for (int t = 0; t < numTrozos; ++t) {
+        const char* corte = t == numTrozos - 1 ? fin : p + tamano * (t + 1) / numTrozos;
+        if (corte < inicio) corte = inicio;
+        while (corte < fin && !esEspacio(*corte)) ++corte;
+        trozos[t].inicio = inicio;
+        trozos[t].fin = corte;
+        inicio = corte;
+    }
+
+    if (numTrozos == 1) {
+        analizarTrozo(&trozos[0]);
+    } else {
+        std::thread* hilos = new std::thread[numTrozos - 1];
+        for (int t = 1; t < numTrozos; ++t) hilos[t - 1] = std::thread(analizarTrozo, &trozos[t]);
+        analizarTrozo(&trozos[0]);
+        for (int t = 1; t < numTrozos; ++t) hilos[t - 1].join();
+        delete[] hilos;
+    }
+
+    // Se concatenan los trozos hasta el primero que encontró un token inválido
+    BufferCreciente resultado;
+    resultado.datos = std::move(trozos[0].valores.datos);
+    resultado.usados = trozos[0].valores.usados;
+    bool detenido = trozos[0].invalido;
+    if (numTrozos > 1) {
+        size_t total = 0;
+        for (int t = 0; t < numTrozos; ++t) {
+            total += trozos[t].valores.usados;
+            if (trozos[t].invalido) break;
+        }
+        reservarBuffer(resultado, total);
+        for (int t = 0; t < numTrozos && !detenido; ++t) {
+            memcpy(resultado.datos.datos() + resultado.usados, trozos[t].valores.datos.datos(),
+                   trozos[t].valores.usados);
+            resultado.usados += trozos[t].valores.usados;
+            detenido = trozos[t].invalido;
+        }
+    }
+    delete[] trozos;
+    return resultado;
+}
+
+// ==============================================
+// FORMATO BINARIO
+// ==============================================
+
+static const int TAMANO_CABECERA_BINARIA = 32;
+
+static void escribirLE(unsigned char* p, uint64_t valor, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = static_cast<unsigned char>(valor >> (8 * i));
+}
+
+static uint64_t leerLE(const unsigned char* p, int bytes) {
+    uint64_t valor = 0;
+    for (int i = bytes - 1; i >= 0; --i) valor = (valor << 8) | p[i];
+    return valor;
+}
+
+void rutaMascaraBinaria(const char* nombreArchivo, char* ruta, int tamanoRuta) {
+    std::string r(nombreArchivo);
+    size_t punto = r.find_last_of('.');
+    size_t barra = r.find_last_of("/\\");
+    if (punto != std::string::npos && (barra == std::string::npos || punto > barra)) {
+        r.erase(punto);
+    }
+    r += ".bin";
+    snprintf(ruta, tamanoRuta, "%s", r.c_str());
+}
+
+bool guardarMascaraBinaria(const char* ruta, int seed, const unsigned char* datos,
+                           int n_pixels) {
+    size_t tamano = static_cast<size_t>(n_pixels) * 3;
+    unsigned char cabecera[TAMANO_CABECERA_BINARIA];
+    memcpy(cabecera, "MSKB", 4);
+    escribirLE(cabecera + 4, VERSION_MASCARA_BINARIA, 4);
+    escribirLE(cabecera + 8, static_cast<uint64_t>(static_cast<int64_t>(seed)), 8);
+    escribirLE(cabecera + 16, static_cast<uint64_t>(n_pixels), 8);
+    escribirLE(cabecera + 24, xxh64(datos, tamano), 8);
+
+    // Se escribe a un temporal y se renombra: un lector nunca ve el archivo a
+    // medias. El temporal lleva algo propio del hilo para que dos cargas del
+    // mismo M<i>.txt no se pisen
+    std::string temporal =
+        std::string(ruta) + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                       static_cast<size_t>(
+                           std::chrono::steady_clock::now().time_since_epoch().count())) +
+        ".tmp";
+    FILE* archivo = fopen(temporal.c_str(), "wb");
+    if (!archivo) return false;
+    bool ok = fwrite(cabecera, 1, sizeof(cabecera), archivo) == sizeof(cabecera) &&
+              fwrite(datos, 1, tamano, archivo) == tamano;
+    ok = fclose(archivo) == 0 && ok;
+
+    std::error_code error;
+    if (ok) std::filesystem::rename(temporal, ruta, error);
+    if (!ok || error) {
+        std::filesystem::remove(temporal, error);
+        return false;
+    }
+    return true;
+}
+
+BufferBytes cargarMascaraBinaria(const char* ruta, int &seed, int &n_pixels) {
+    ArchivoMapeado mapa;
+    if (!abrirArchivoMapeado(mapa, ruta)) return BufferBytes();
+
+    BufferBytes datos;
+    const unsigned char* p = mapa.datos;
+    if (mapa.tamano >= static_cast<size_t>(TAMANO_CABECERA_BINARIA) &&
+        memcmp(p, "MSKB", 4) == 0 &&
+        leerLE(p + 4, 4) == VERSION_MASCARA_BINARIA) {
+        uint64_t pixeles = leerLE(p + 16, 8);
+        uint64_t tamano = pixeles * 3;
+        if (pixeles <= 0x7FFFFFFF && tamano == mapa.tamano - TAMANO_CABECERA_BINARIA &&
+            xxh64(p + TAMANO_CABECERA_BINARIA, tamano) == leerLE(p + 24, 8)) {
+            seed = static_cast<int>(static_cast<int64_t>(leerLE(p + 8, 8)));
+            n_pixels = static_cast<int>(pixeles);
+            datos = BufferBytes(tamano > 0 ? tamano : 1);
+            memcpy(datos.datos(), p + TAMANO_CABECERA_BINARIA, tamano);
+        }
+    }
+    cerrarArchivoMapeado(mapa);
+    return datos;
+}
+
+// Indica si el binario existe y es más reciente que el texto (o el texto no existe)
+static bool binarioVigente(const char* nombreArchivo, const char* rutaBinaria) {
+    std::error_code error;
+    std::filesystem::file_time_type binario =
+        std::filesystem::last_write_time(rutaBinaria, error);
+    if (error) return false;
+    std::filesystem::file_time_type texto =
+        std::filesystem::last_write_time(nombreArchivo, error);
+    return error || binario > texto;
+}
+
+// ==============================================
+// CARGA
+// ==============================================
+
+// Analiza el archivo de texto
+static BufferBytes cargarMascaraTexto(const char* nombreArchivo, int &seed, int &n_pixels) {
+    ArchivoMapeado mapa;
+    if (!abrirArchivoMapeado(mapa, nombreArchivo)) {
+        return BufferBytes();
+    }
+
+    const char* p = reinterpret_cast<const char*>(mapa.datos);
+    const char* fin = p + mapa.tamano;
+
+    // La semilla es el primer entero del archivo
+    p = saltarEspacios(p, fin);
+    std::from_chars_result r = std::from_chars(p, fin, seed);
+    if (mapa.tamano == 0 || r.ec != std::errc()) {
+        cerrarArchivoMapeado(mapa);
+        return BufferBytes();
+    }
+
+    BufferCreciente valores = analizarEnParalelo(r.ptr, fin);
+    cerrarArchivoMapeado(mapa);
+
+    // Solo cuentan las tripletas completas
+    n_pixels = static_cast<int>(valores.usados / 3);
+    return std::move(valores.datos);
+}
+
+BufferBytes loadSeedMasking(const char* nombreArchivo, int &seed, int &n_pixels) {
+    MedicionFase medicion(FASE_CARGA_ENMASCARAMIENTO);
+    char rutaBinaria[1024];
+    rutaMascaraBinaria(nombreArchivo, rutaBinaria, sizeof(rutaBinaria));
+
+    if (binarioVigente(nombreArchivo, rutaBinaria)) {
+        BufferBytes datos = cargarMascaraBinaria(rutaBinaria, seed, n_pixels);
+        if (datos) return datos;
+    }
+
+    BufferBytes datos = cargarMascaraTexto(nombreArchivo, seed, n_pixels);
+    if (datos) {
+        // Si no se puede escribir (p. ej. directorio de solo lectura) se sigue igual
+        guardarMascaraBinaria(rutaBinaria, seed, datos.datos(), n_pixels);
+    }
+    return datos;
+}
+
+void rutaEnmascaramiento(const char* directorio, int numero, char* ruta, int tamanoRuta) {
+    if (directorio[0] == '\0') snprintf(ruta, tamanoRuta, "M%d.txt", numero);
+    else snprintf(ruta, tamanoRuta, "%s/M%d.txt", directorio, numero);
+}
+
+int contarArchivosEnmascaramiento(const char* directorio, int maximo) {
+    int n = 0;
+    while (n < maximo) {
+        char texto[1024], binario[1024];
+        rutaEnmascaramiento(directorio, n + 1, texto, sizeof(texto));
+        rutaMascaraBinaria(texto, binario, sizeof(binario));
+        std::error_code error;
+        if (!std::filesystem::exists(texto, error) && !std::filesystem::exists(binario, error)) break;
+        ++n;
+    }
+    return n;
+}
+
+int cargarArchivosEnmascaramiento(const char* directorio, int maximo,
+                                  std::vector<BufferBytes>& datos, std::vector<int>& seeds,
+                                  std::vector<int>& pixeles, std::string& error) {
+    int n = contarArchivosEnmascaramiento(directorio, maximo);
+    if (n == 0) {
+        error = "No se encontro M1.txt";
+        return 0;
+    }
+    datos.resize(n);
+    seeds.resize(n);
+    pixeles.resize(n);
+    for (int i = 0; i < n; ++i) {
+        char filename[1024];
+        rutaEnmascaramiento(directorio, i + 1, filename, sizeof(filename));
+        datos[i] = loadSeedMasking(filename, seeds[i], pixeles[i]);
+        if (!datos[i]) {
+            error = std::string("Error al cargar archivo de enmascaramiento: ") + filename;
+            return 0;
+        }
+    }
+    return n;
+}
+
+bool comprobarEnmascaramientos(const std::vector<int>& pixeles, size_t maskBytes,
+                               std::string& error) {
+    for (size_t i = 0; i < pixeles.size(); ++i) {
+        size_t valores = static_cast<size_t>(pixeles[i]) * 3;
+        if (valores < maskBytes) {
+            error = "M" + std::to_string(i + 1) + ".txt tiene " + std::to_string(valores) +
+                    " valores, M.bmp necesita " + std::to_string(maskBytes);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef CARGA_DATOS_H
+#define CARGA_DATOS_H
+
+#include <string>
+#include <vector>
+
+#include "memoria.h"
+
+// ==============================================
+// CARGA DE ARCHIVOS DE ENMASCARAMIENTO
+// ==============================================
+
+// Carga la semilla y los resultados del enmascaramiento de un archivo de texto
+// (semilla y luego tripletas RGB). El archivo se mapea en memoria y se
+// recorre una sola vez; los archivos grandes se analizan por trozos en
+// paralelo.
+//
+// Si junto al .txt hay un archivo binario equivalente (M1.txt -> M1.bin) más
+// reciente que el texto, se lee ese en su lugar. Si no lo hay, se escribe
+// tras analizar el texto para que la siguiente carga sea inmediata.
+//
+// Cada valor se guarda empaquetado en un byte (módulo 256). verifyMasking
+// compara la suma de dos bytes, que también es módulo 256, así que no se
+// pierde nada: una suma real de hasta 510 coincide si y solo si coincide su
+// byte bajo.
+//
+// Devuelve un buffer vacío si el archivo no existe o no empieza con una
+// semilla. El buffer puede ser más grande que n_pixels * 3.
+BufferBytes loadSeedMasking(const char* nombreArchivo, int &seed, int &n_pixels);
+
+// Ruta de M<numero>.txt dentro de 'directorio' ("" = el directorio actual)
+void rutaEnmascaramiento(const char* directorio, int numero, char* ruta, int tamanoRuta);
+
+// Cuenta los archivos M1.txt, M2.txt, ... consecutivos que existen en
+// 'directorio' (en texto o solo en su versión binaria), hasta 'maximo'.
+int contarArchivosEnmascaramiento(const char* directorio, int maximo);
+
+// Carga todos los archivos de enmascaramiento de 'directorio' (ver
+// contarArchivosEnmascaramiento): datos[i], seeds[i] y pixeles[i] (su
+// n_pixels) son los de M<i+1>.txt. Devuelve cuántos hay, o 0 con el motivo
+// en 'error' si no hay ninguno o alguno no se pudo cargar.
+int cargarArchivosEnmascaramiento(const char* directorio, int maximo,
+                                  std::vector<BufferBytes>& datos, std::vector<int>& seeds,
+                                  std::vector<int>& pixeles, std::string& error);
+
+// La búsqueda lee maskBytes (ancho * alto * 3 de M) valores de cada
+// enmascaramiento; un archivo más corto la haría leer fuera del buffer.
+// Devuelve false con el motivo en 'error' si alguno de 'pixeles' (los
+// n_pixels de M1.txt, M2.txt, ...) no alcanza.
+bool comprobarEnmascaramientos(const std::vector<int>& pixeles, size_t maskBytes,
+                               std::string& error);
+
+// ==============================================
+// FORMATO BINARIO DE ENMASCARAMIENTO
+// ==============================================
+// Cabecera de 32 bytes en little-endian seguida de los valores empaquetados
+// (3 bytes por píxel, mismo orden que el texto):
+//   0  "MSKB"            identificador
+//   4  uint32 versión    VERSION_MASCARA_BINARIA
+//   8  int64  semilla
+//   16 uint64 n_pixels
+//   24 uint64 XXH64 de los valores
+
+const unsigned int VERSION_MASCARA_BINARIA = 1;
+
+// Ruta del binario asociado a un archivo de texto (extensión cambiada a .bin)
+void rutaMascaraBinaria(const char* nombreArchivo, char* ruta, int tamanoRuta);
+
+// Escribe el archivo de forma atómica (temporal + renombrado).
+bool guardarMascaraBinaria(const char* ruta, int seed, const unsigned char* datos,
+                           int n_pixels);
+
+// Devuelve un buffer vacío si el archivo no existe, no tiene el formato o la
+// versión esperados, o la suma de verificación no coincide.
+BufferBytes cargarMascaraBinaria(const char* ruta, int &seed, int &n_pixels);
+
+#endif // CARGA_DATOS_H
@@ -0,0 +1,218 @@
+#include "codificacion.h"
+
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "carga_datos.h"
+#include "memoria.h"
+#include "operaciones_bits.h"
+
+// Filas que toma un hilo cada vez
+static const int FILAS_POR_BLOQUE = 16;
+
+// ==============================================
+// CODIFICACIÓN POR FILAS
+// ==============================================
+
+struct TrabajoCodificacion {
+    const VistaBMP* original;
+    const VistaBMP* IM;
+    const Transformation* secuencia;
+    int profundidad;
+    const int* seeds;
+    int maskSize;
+    unsigned char** etapas;
+    unsigned char* pixelesSalida;   // datos de píxeles del BMP de salida
+    size_t stride;
+    int numBloques;
+    std::atomic<int> siguienteBloque;
+};
+
+// Copia a 'destino' los bytes de la ventana [seed, seed + maskSize) (con
+// vuelta al inicio de la imagen) que caen en la fila y. La fila está en BGR,
+// como en el archivo; la ventana se indexa en RGB, como en loadPixels.
+static void capturarVentana(const unsigned char* fila, int y, size_t bytesFila, size_t imgSize,
+                            int seed, int maskSize, unsigned char* destino) {
+    if (maskSize <= 0) return;
+    size_t a = static_cast<size_t>(y) * bytesFila;
+    size_t b = a + bytesFila;
+    size_t inicio = static_cast<size_t>(seed);
+    size_t fin = inicio + maskSize;
+    // Cada vuelta m de la ventana sobre la imagen se intersecta con la fila
+    for (size_t m = inicio / imgSize; m <= (fin - 1) / imgSize; ++m) {
+        size_t desde = a + m * imgSize > inicio ? a + m * imgSize : inicio;
+        size_t hasta = b + m * imgSize < fin ? b + m * imgSize : fin;
+        for (size_t u = desde; u < hasta; ++u) {
+            size_t c = u - m * imgSize - a;
+            destino[u - inicio] = fila[c - c % 3 + 2 - c % 3];
+        }
+    }
+}
+
+static void codificarFilas(TrabajoCodificacion* t) {
+    const VistaBMP& original = *t->original;
+    size_t bytesFila = static_cast<size_t>(original.width) * 3;
+    size_t imgSize = bytesFila * original.height;
+
+    for (;;) {
+        int bloque = t->siguienteBloque.fetch_add(1, std::memory_order_relaxed);
+        if (bloque >= t->numBloques) break;
+        int y0 = bloque * FILAS_POR_BLOQUE;
+        int y1 = y0 + FILAS_POR_BLOQUE < original.height ? y0 + FILAS_POR_BLOQUE : original.height;
+
+        for (int y = y0; y < y1; ++y) {
+            // La salida se guarda de abajo hacia arriba
+            unsigned char* fila = t->pixelesSalida +
+                                  static_cast<size_t>(original.height - 1 - y) * t->stride;
+            memcpy(fila, filaBMP(original, y), bytesFila);
+            memset(fila + bytesFila, 0, t->stride - bytesFila);
+
+            // Todas las etapas sobre la fila mientras está en caché. XOR y
+            // rotación actúan byte a byte, así que el orden BGR da igual.
+            const unsigned char* filaIM = filaBMP(*t->IM, y);
+            for (int s = 0; s < t->profundidad; ++s) {
+                applyTransformation(fila, filaIM, t->secuencia[s], bytesFila);
+                if (s + 1 < t->profundidad) {
+                    capturarVentana(fila, y, bytesFila, imgSize, t->seeds[s], t->maskSize,
+                                    t->etapas[s]);
+                }
+            }
+        }
+        descartarFilasBMP(original, y0, y1 - y0);
+        descartarFilasBMP(*t->IM, y0, y1 - y0);
+    }
+}
+
+bool codificarImagen(const VistaBMP& original, const VistaBMP& IM,
+                     const Transformation* secuencia, int profundidad,
+                     const int* seeds, int maskSize, unsigned char** etapas,
+                     const char* rutaSalida, int numHilos) {
+    if (original.width != IM.width || original.height != IM.height) return false;
+    for (int s = 0; s + 1 < profundidad; ++s) {
+        if (seeds[s] < 0) return false;
+    }
+
+    unsigned char cabecera[TAMANO_CABECERA_BMP];
+    if (!escribirCabeceraBMP(cabecera, original.width, original.height)) return false;
+    size_t stride = (static_cast<size_t>(original.width) * 3 + 3) & ~static_cast<size_t>(3);
+
+    ArchivoMapeado salida;
+    if (!crearArchivoMapeado(salida, rutaSalida,
+                             TAMANO_CABECERA_BMP + stride * original.height)) {
+        return false;
+    }
+    memcpy(salida.datos, cabecera, TAMANO_CABECERA_BMP);
+
+    TrabajoCodificacion t;
+    t.original = &original;
+    t.IM = &IM;
+    t.secuencia = secuencia;
+    t.profundidad = profundidad;
+    t.seeds = seeds;
+    t.maskSize = maskSize;
+    t.etapas = etapas;
+    t.pixelesSalida = salida.datos + TAMANO_CABECERA_BMP;
+    t.stride = stride;
+    t.numBloques = (original.height + FILAS_POR_BLOQUE - 1) / FILAS_POR_BLOQUE;
+    t.siguienteBloque.store(0);
+
+    if (numHilos <= 0) numHilos = static_cast<int>(std::thread::hardware_concurrency());
+    if (numHilos > t.numBloques) numHilos = t.numBloques;
+    if (numHilos < 1) numHilos = 1;
+
+    std::thread* hilos = new std::thread[numHilos - 1];
+    for (int h = 1; h < numHilos; ++h) hilos[h - 1] = std::thread(codificarFilas, &t);
+    codificarFilas(&t);
+    for (int h = 1; h < numHilos; ++h) hilos[h - 1].join();
+    delete[] hilos;
+
+    cerrarArchivoMapeado(salida);
+    return true;
+}
+
+// ==============================================
+// ARCHIVOS DE ENMASCARAMIENTO
+// ==============================================
+
+bool guardarEnmascaramiento(const char* ruta, int seed, const unsigned char* valores,
+                            const unsigned char* mask, int maskSize, bool conBinario) {
+    // Cada suma ocupa como mucho 3 cifras y un separador
+    BufferBytes texto(static_cast<size_t>(maskSize) * 4 + 16);
+    char* inicio = reinterpret_cast<char*>(texto.datos());
+    char* fin = inicio + texto.tamano();
+    char* p = std::to_chars(inicio, fin, seed).ptr;
+    *p++ = '\n';
+    for (int k = 0; k + 3 <= maskSize; k += 3) {
+        for (int c = 0; c < 3; ++c) {
+            p = std::to_chars(p, fin, valores[k + c] + mask[k + c]).ptr;
+            *p++ = c < 2 ? ' ' : '\n';
+        }
+    }
+
+    FILE* archivo = fopen(ruta, "wb");
+    if (!archivo) return false;
+    size_t tamano = static_cast<size_t>(p - inicio);
+    bool ok = fwrite(inicio, 1, tamano, archivo) == tamano;
+    ok = fclose(archivo) == 0 && ok;
+    if (!ok || !conBinario) return ok;
+
+    // El binario guarda las sumas empaquetadas en un byte, como loadSeedMasking
+    BufferBytes empaquetados(maskSize > 0 ? maskSize : 1);
+    for (int k = 0; k < maskSize; ++k) {
+        empaquetados.datos()[k] = static_cast<unsigned char>(valores[k] + mask[k]);
+    }
+    char rutaBinaria[1024];
+    rutaMascaraBinaria(ruta, rutaBinaria, sizeof(rutaBinaria));
+    return guardarMascaraBinaria(rutaBinaria, seed, empaquetados.datos(), maskSize / 3);
+}
+
+// ==============================================
+// SECUENCIAS EN TEXTO
+// ==============================================
+
+int leerSecuencia(const char* texto, Transformation* secuencia) {
+    int n = 0;
+    const char* p = texto;
+    while (*p) {
+        if (n == MAX_PASOS) return -1;
+        char tipo = static_cast<char>(toupper(static_cast<unsigned char>(*p++)));
+        if (tipo == 'X') {
+            secuencia[n++] = {XOR_OP, 0};
+        } else if (tipo == 'R' || tipo == 'L') {
+            int bits = 0;
+            std::from_chars_result r = std::from_chars(p, p + strlen(p), bits);
+            if (r.ec != std::errc() || bits < 1 || bits > MAX_BITS) return -1;
+            p = r.ptr;
+            secuencia[n++] = {tipo == 'R' ? ROTATE_RIGHT_OP : ROTATE_LEFT_OP, bits};
+        } else {
+            return -1;
+        }
+        if (*p == ',') {
+            ++p;
+            if (!*p) return -1;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    return n > 0 ? n : -1;
+}
+
+void escribirSecuencia(const Transformation* secuencia, int n, char* texto, int tamanoTexto) {
+    int usados = 0;
+    texto[0] = '\0';
+    for (int i = 0; i < n && usados < tamanoTexto; ++i) {
+        const char* separador = i > 0 ? "," : "";
+        if (secuencia[i].type == XOR_OP) {
+            usados += snprintf(texto + usados, tamanoTexto - usados, "%sX", separador);
+        } else {
+            usados += snprintf(texto + usados, tamanoTexto - usados, "%s%c%d", separador,
+                               secuencia[i].type == ROTATE_RIGHT_OP ? 'R' : 'L',
+                               secuencia[i].bits);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef CODIFICACION_H
+#define CODIFICACION_H
+
+#include "imagen_bmp.h"
+#include "transformaciones.h"
+
+// ==============================================
+// CODIFICADOR (SENTIDO DIRECTO)
+// ==============================================
+// Genera casos del desafío con el mismo modelo por etapas que la búsqueda
+// (ver busqueda.h): P0 = I_O, Ps = T[s-1](P(s-1)), I_D = P(profundidad), y
+// M<s>.txt es el enmascaramiento de Ps para s = 1 .. profundidad-1. La
+// última etapa no tiene archivo: su resultado es la propia I_D.
+
+// Aplica la secuencia a 'original' (con 'IM') y escribe I_D en 'rutaSalida'
+// como BMP de 24 bits. Las filas se reparten entre 'numHilos' hilos (0 = uno
+// por núcleo) y cada una pasa por todas las etapas de una vez, directamente
+// sobre el archivo de salida mapeado; ninguna imagen completa pasa por RAM.
+//
+// Para cada etapa s = 1 .. profundidad-1 deja en etapas[s-1] los maskSize
+// bytes de Ps a partir de seeds[s-1] (con la misma vuelta al inicio que
+// verifyMasking). Devuelve false si las imágenes no coinciden en tamaño o
+// no se pudo escribir la salida.
+bool codificarImagen(const VistaBMP& original, const VistaBMP& IM,
+                     const Transformation* secuencia, int profundidad,
+                     const int* seeds, int maskSize, unsigned char** etapas,
+                     const char* rutaSalida, int numHilos);
+
+// Escribe un archivo de enmascaramiento en el formato que lee
+// loadSeedMasking: la semilla y luego, por cada píxel, las sumas
+// valores[k] + mask[k] (sin módulo, de 0 a 510). Si 'conBinario', también
+// escribe el .bin equivalente para que la primera carga sea inmediata.
+bool guardarEnmascaramiento(const char* ruta, int seed, const unsigned char* valores,
+                            const unsigned char* mask, int maskSize, bool conBinario);
+
+// Lee una secuencia escrita como "X,R3,L2" (XOR, rotación derecha de 3 bits,
+// rotación izquierda de 2). Devuelve el número de transformaciones o -1 si
+// el texto no es válido o tiene más de MAX_PASOS.
+int leerSecuencia(const char* texto, Transformation* secuencia);
+
+// Escribe la secuencia en el mismo formato que leerSecuencia.
+void escribirSecuencia(const Transformation* secuencia, int n, char* texto, int tamanoTexto);
+
+#endif // CODIFICACION_H
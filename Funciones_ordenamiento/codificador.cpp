@@ -0,0 +1,226 @@
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "codificacion.h"
+#include "imagen_bmp.h"
+#include "imagenes.h"
+#include "memoria.h"
+#include "operaciones_bits.h"
+
+using namespace std;
+
+// ==============================================
+// CODIFICADOR DE CASOS DE PRUEBA
+// ==============================================
+// Toma I_O.bmp, I_M.bmp y M.bmp del directorio de entrada y genera casos
+// completos (I_D.bmp y M1.txt .. M<profundidad-1>.txt) que el programa de
+// reconstrucción puede resolver. Uso:
+//   codificador [--entrada DIR] [--salida DIR] [--secuencia X,R3,X]
+//               [--profundidad N] [--casos N] [--semilla N] [--threads N]
+//               [--sin-binario]
+// Sin --secuencia se elige una al azar, empezando por XOR, de la profundidad
+// indicada (3 por defecto). Con --casos N se generan N casos en
+// DIR/caso_0001, ... cada uno con sus propias semillas (y su secuencia, si es
+// al azar).
+
+struct OpcionesCodificador {
+    string entrada = ".";
+    string salida = ".";
+    Transformation secuencia[MAX_PASOS];
+    int profundidad = 0;       // 0 = la de --secuencia, o 3 si no hay
+    bool secuenciaFija = false;
+    int numCasos = 0;          // 0 = un solo caso directamente en --salida
+    unsigned long long semilla = 0;
+    bool semillaFija = false;
+    int numHilos = 0;          // 0 = un hilo por núcleo
+    bool conBinario = true;
+};
+
+// Deja 'origen' accesible como 'destino' sin copiar si se puede (enlace
+// duro), copiándolo si no.
+static bool enlazarOCopiar(const string& origen, const string& destino) {
+    error_code error;
+    if (filesystem::equivalent(origen, destino, error)) return true;
+    filesystem::remove(destino, error);
+    filesystem::create_hard_link(origen, destino, error);
+    if (!error) return true;
+    error.clear();
+    filesystem::copy_file(origen, destino, filesystem::copy_options::overwrite_existing, error);
+    return !error;
+}
+
+// Genera un caso en 'directorio'. Devuelve false (tras avisar) si algo falla.
+static bool generarCaso(const OpcionesCodificador& opciones, const string& directorio,
+                        const VistaBMP& original, const VistaBMP& IM,
+                        const unsigned char* mask, int maskSize,
+                        const Transformation* secuencia, int profundidad, mt19937_64& generador) {
+    error_code error;
+    filesystem::create_directories(directorio, error);
+
+    size_t imgSize = static_cast<size_t>(original.width) * original.height * 3;
+    size_t maxSemilla = imgSize - 1 < static_cast<size_t>(INT_MAX) ? imgSize - 1 : INT_MAX;
+    int seeds[MAX_PASOS];
+    vector<BufferBytes> ventanas(profundidad);
+    unsigned char* etapas[MAX_PASOS];
+    for (int s = 0; s + 1 < profundidad; ++s) {
+        seeds[s] = static_cast<int>(generador() % (maxSemilla + 1));
+        ventanas[s] = BufferBytes(maskSize > 0 ? maskSize : 1);
+        etapas[s] = ventanas[s].datos();
+    }
+
+    string rutaID = directorio + "/I_D.bmp";
+    if (!codificarImagen(original, IM, secuencia, profundidad, seeds, maskSize, etapas,
+                         rutaID.c_str(), opciones.numHilos)) {
+        cerr << "Error al escribir: " << rutaID << endl;
+        return false;
+    }
+    for (int s = 0; s + 1 < profundidad; ++s) {
+        string ruta = directorio + "/M" + to_string(s + 1) + ".txt";
+        if (!guardarEnmascaramiento(ruta.c_str(), seeds[s], etapas[s], mask, maskSize,
+                                    opciones.conBinario)) {
+            cerr << "Error al escribir: " << ruta << endl;
+            return false;
+        }
+    }
+
+    // El caso queda listo para ejecutar el reconstructor dentro del directorio
+    const char* copias[] = {"I_O.bmp", "I_M.bmp", "M.bmp"};
+    for (const char* nombre : copias) {
+        if (!enlazarOCopiar(opciones.entrada + "/" + nombre, directorio + "/" + nombre)) {
+            cerr << "No se pudo copiar " << nombre << " a " << directorio << endl;
+            return false;
+        }
+    }
+    char texto[MAX_PASOS * 4 + 1];
+    escribirSecuencia(secuencia, profundidad, texto, sizeof(texto));
+    FILE* archivo = fopen((directorio + "/secuencia.txt").c_str(), "w");
+    if (archivo) {
+        fprintf(archivo, "%s\n", texto);
+        fclose(archivo);
+    }
+    cout << directorio << ": " << texto << endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesCodificador opciones;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--entrada") == 0 && i + 1 < argc) {
+            opciones.entrada = argv[++i];
+        } else if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) {
+            opciones.salida = argv[++i];
+        } else if (strcmp(argv[i], "--secuencia") == 0 && i + 1 < argc) {
+            int n = leerSecuencia(argv[++i], opciones.secuencia);
+            if (n < 0) {
+                cerr << "Secuencia no valida: " << argv[i]
+                     << " (ejemplo: X,R3,L2; hasta " << MAX_PASOS << " pasos)" << endl;
+                return 1;
+            }
+            if (opciones.profundidad != 0 && opciones.profundidad != n) {
+                cerr << "--secuencia y --profundidad no coinciden" << endl;
+                return 1;
+            }
+            opciones.profundidad = n;
+            opciones.secuenciaFija = true;
+        } else if (strcmp(argv[i], "--profundidad") == 0 && i + 1 < argc) {
+            int profundidad = atoi(argv[++i]);
+            if (profundidad < 1 || profundidad > MAX_PASOS) {
+                cerr << "La profundidad debe estar entre 1 y " << MAX_PASOS << endl;
+                return 1;
+            }
+            if (opciones.secuenciaFija && profundidad != opciones.profundidad) {
+                cerr << "--secuencia y --profundidad no coinciden" << endl;
+                return 1;
+            }
+            opciones.profundidad = profundidad;
+        } else if (strcmp(argv[i], "--casos") == 0 && i + 1 < argc) {
+            opciones.numCasos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            opciones.semilla = strtoull(argv[++i], nullptr, 10);
+            opciones.semillaFija = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opciones.numHilos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sin-binario") == 0) {
+            opciones.conBinario = false;
+        } else {
+            cerr << "Opcion desconocida: " << argv[i] << endl;
+            return 1;
+        }
+    }
+    if (opciones.profundidad == 0) opciones.profundidad = 3;
+    if (opciones.secuenciaFija && opciones.secuencia[0].type != XOR_OP) {
+        cerr << "Aviso: la secuencia no empieza por X; el reconstructor devolvera "
+             << "una imagen distinta de I_O (el primer paso no se puede verificar)" << endl;
+    }
+
+    // Cargar imágenes: I_O e I_M se leen mapeadas, por filas
+    string rutaOriginal = opciones.entrada + "/I_O.bmp";
+    string rutaIM = opciones.entrada + "/I_M.bmp";
+    VistaBMP original, IM;
+    if (!abrirBMP(original, rutaOriginal.c_str())) {
+        cerr << "Error al cargar: " << rutaOriginal << " (se necesita un BMP de 24 bits)" << endl;
+        return 1;
+    }
+    if (!abrirBMP(IM, rutaIM.c_str())) {
+        cerr << "Error al cargar: " << rutaIM << " (se necesita un BMP de 24 bits)" << endl;
+        return 1;
+    }
+    if (original.width != IM.width || original.height != IM.height) {
+        cerr << "I_O.bmp e I_M.bmp no tienen el mismo tamaño" << endl;
+        return 1;
+    }
+    int maskWidth, maskHeight;
+    BufferBytes mask = loadPixels(QString::fromStdString(opciones.entrada + "/M.bmp"),
+                                  maskWidth, maskHeight);
+    if (!mask) {
+        cerr << "Error al cargar: " << opciones.entrada << "/M.bmp" << endl;
+        return 1;
+    }
+    int maskSize = maskWidth * maskHeight * 3;
+
+    if (!opciones.semillaFija) opciones.semilla = random_device()();
+    mt19937_64 generador(opciones.semilla);
+    cout << "Semilla: " << opciones.semilla << endl;
+
+    Transformation todas[NUM_TRANSFORMACIONES];
+    int numTodas;
+    generatePossibleTransformations(todas, numTodas);
+
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    int numCasos = opciones.numCasos > 0 ? opciones.numCasos : 1;
+    bool ok = true;
+    for (int c = 0; c < numCasos && ok; ++c) {
+        // Ningún archivo revisa P0, así que el reconstructor toma XOR como
+        // primer paso; las secuencias al azar empiezan por XOR para que el
+        // caso tenga una sola solución.
+        Transformation secuencia[MAX_PASOS];
+        for (int s = 0; s < opciones.profundidad; ++s) {
+            if (opciones.secuenciaFija) secuencia[s] = opciones.secuencia[s];
+            else secuencia[s] = s == 0 ? todas[0] : todas[generador() % numTodas];
+        }
+        string directorio = opciones.salida;
+        if (opciones.numCasos > 0) {
+            char nombre[32];
+            snprintf(nombre, sizeof(nombre), "/caso_%04d", c + 1);
+            directorio += nombre;
+        }
+        ok = generarCaso(opciones, directorio, original, IM, mask.datos(), maskSize,
+                         secuencia, opciones.profundidad, generador);
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    double mpx = static_cast<double>(original.width) * original.height * numCasos / 1e6;
+    cout << "Casos: " << numCasos << "\tTiempo: " << segundos << " s"
+         << "\tRendimiento: " << (segundos > 0.0 ? mpx / segundos : 0.0) << " Mpx/s" << endl;
+
+    cerrarBMP(original);
+    cerrarBMP(IM);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "enmascaramiento.h"
+
+#include "operaciones_bits.h"
+#include "perfilado.h"
+
+bool verifyMasking(unsigned char* image, unsigned char* mask,
+                   int imgWidth, int imgHeight,
+                   int maskWidth, int maskHeight,
+                   int seed, unsigned char* maskingData) {
+    size_t imgSize = static_cast<size_t>(imgWidth) * imgHeight * 3;
+    size_t maskSize = static_cast<size_t>(maskWidth) * maskHeight * 3;
+
+    // La ventana (seed + k) % imgSize se parte en tramos contiguos: el que va
+    // hasta el final de la imagen y, si da la vuelta, el que empieza en 0.
+    size_t pos = static_cast<size_t>(seed) % imgSize;
+    size_t k = 0;
+    while (k < maskSize) {
+        size_t tramo = maskSize - k < imgSize - pos ? maskSize - k : imgSize - pos;
+        size_t diferencia = primeraDiferenciaSuma(image + pos, mask + k, maskingData + k, tramo);
+        if (diferencia < tramo) {
+            contarVerificacion(k + diferencia, maskSize);
+            return false;
+        }
+        k += tramo;
+        pos = 0;
+    }
+    contarVerificacion(maskSize, maskSize);
+    return true;
+}
+
+// ==============================================
+// EVALUACIÓN DISPERSA
+// ==============================================
+
+void reservarVentanaDispersa(VentanaDispersa& ventana, int numSemillas, int maskSize) {
+    size_t total = static_cast<size_t>(numSemillas) * maskSize;
+    ventana.numSemillas = numSemillas;
+    ventana.maskSize = maskSize;
+    ventana.imagen = ventana.IM = ventana.trabajo = nullptr;
+    // La marca se toma antes de reservar: si una reserva lanza bad_alloc,
+    // liberarVentanaDispersa devuelve lo que sí se reservó
+    ventana.arena = &arenaDelHilo();
+    ventana.marca = ventana.arena->marca();
+    ventana.imagen = ventana.arena->reservar(total);
+    ventana.IM = ventana.arena->reservar(total);
+    ventana.trabajo = ventana.arena->reservar(total);
+}
+
+void crearVentanaDispersa(VentanaDispersa& ventana,
+                          const unsigned char* image, const unsigned char* IM,
+                          size_t imgSize, const int* seeds, int numSemillas,
+                          int maskSize) {
+    reservarVentanaDispersa(ventana, numSemillas, maskSize);
+    for (int s = 0; s < numSemillas; ++s) {
+        for (int k = 0; k < maskSize; ++k) {
+            size_t pos = (seeds[s] + static_cast<size_t>(k)) % imgSize;
+            ventana.imagen[static_cast<size_t>(s) * maskSize + k] = image[pos];
+            ventana.IM[static_cast<size_t>(s) * maskSize + k] = IM[pos];
+        }
+    }
+}
+
+void liberarVentanaDispersa(VentanaDispersa& ventana) {
+    if (ventana.arena) ventana.arena->volverA(ventana.marca);
+    ventana.arena = nullptr;
+    ventana.imagen = ventana.IM = ventana.trabajo = nullptr;
+}
+
+bool verificarTramo(const unsigned char* valores, const unsigned char* mask,
+                    int maskSize, const unsigned char* maskingData) {
+    size_t k = primeraDiferenciaSuma(valores, mask, maskingData, maskSize);
+    contarVerificacion(k, maskSize);
+    return k == static_cast<size_t>(maskSize);
+}
@@ -0,0 +1,48 @@
+#ifndef ENMASCARAMIENTO_H
+#define ENMASCARAMIENTO_H
+
+#include "memoria.h"
+
+// ==============================================
+// VERIFICACIÓN DEL ENMASCARAMIENTO
+// ==============================================
+
+bool verifyMasking(unsigned char* image, unsigned char* mask,
+                   int imgWidth, int imgHeight,
+                   int maskWidth, int maskHeight,
+                   int seed, unsigned char* maskingData);
+
+// Copia compacta de los únicos bytes que verifyMasking lee: para cada semilla,
+// los maskSize bytes a partir de (seed + k) % imgSize. Como XOR y rotación
+// actúan byte a byte, un candidato puede evaluarse sobre esta copia sin tocar
+// el resto de la imagen.
+//
+// Los buffers salen de la arena del hilo que crea la ventana, así que crear
+// y liberar ventanas repetidamente no toca el heap. Por eso la ventana se
+// libera en el mismo hilo y después de lo que se haya reservado en esa arena
+// mientras existía (las búsquedas ya lo hacen); otros hilos pueden leerla.
+struct VentanaDispersa {
+    int numSemillas;
+    int maskSize;
+    unsigned char* imagen;   // bytes de la imagen, semilla tras semilla
+    unsigned char* IM;       // bytes de IM en las mismas posiciones
+    unsigned char* trabajo;  // buffer donde se evalúan los candidatos
+    ArenaTemporal* arena;    // nulo si la ventana no llegó a reservarse
+    ArenaTemporal::Marca marca;
+};
+
+// Reserva los buffers de la ventana (sin llenarlos)
+void reservarVentanaDispersa(VentanaDispersa& ventana, int numSemillas, int maskSize);
+
+void crearVentanaDispersa(VentanaDispersa& ventana,
+                          const unsigned char* image, const unsigned char* IM,
+                          size_t imgSize, const int* seeds, int numSemillas,
+                          int maskSize);
+
+void liberarVentanaDispersa(VentanaDispersa& ventana);
+
+// Equivalente a verifyMasking sobre el tramo de una semilla ya compactado.
+bool verificarTramo(const unsigned char* valores, const unsigned char* mask,
+                    int maskSize, const unsigned char* maskingData);
+
+#endif // ENMASCARAMIENTO_H
@@ -0,0 +1,219 @@
+#include "fragmentos.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "codificacion.h"
+
+static const char* NOMBRES_ESTADO[] = {"en_curso", "encontrada", "ninguna"};
+
+static std::string rutaInforme(const char* directorio, int indice, int total) {
+    char nombre[64];
+    snprintf(nombre, sizeof(nombre), "fragmento_%d_de_%d.txt", indice, total);
+    return (std::filesystem::path(directorio) / nombre).string();
+}
+
+bool leerIndiceFragmento(const char* texto, int& indice, int& total) {
+    char resto;
+    return sscanf(texto, "%d/%d%c", &indice, &total, &resto) == 2 && indice >= 1 &&
+           indice <= total && total <= MAX_FRAGMENTOS;
+}
+
+// ==============================================
+// ARCHIVOS DE INFORME
+// ==============================================
+
+// Se escribe a un temporal y se renombra: quien une nunca ve un informe a medias
+static bool escribirInforme(const char* directorio, const InformeFragmento& informe) {
+    std::string ruta = rutaInforme(directorio, informe.indice, informe.total);
+    std::string temporal = ruta + ".tmp";
+    FILE* archivo = fopen(temporal.c_str(), "w");
+    if (!archivo) return false;
+    fprintf(archivo, "fragmento %d/%d\n", informe.indice, informe.total);
+    fprintf(archivo, "caso %016llx\n", static_cast<unsigned long long>(informe.caso));
+    fprintf(archivo, "profundidad %d\n", informe.profundidad);
+    fprintf(archivo, "tareas %lld/%lld\n", informe.tareasHechas, informe.tareasPropias);
+    fprintf(archivo, "estado %s\n", NOMBRES_ESTADO[informe.estado]);
+    if (informe.estado == FRAGMENTO_ENCONTRADA) {
+        char texto[MAX_PASOS * 4 + 1];
+        escribirSecuencia(informe.secuencia, informe.profundidad, texto, sizeof(texto));
+        fprintf(archivo, "tarea %lld\n", informe.tarea);
+        fprintf(archivo, "secuencia %s\n", texto);
+    }
+    bool ok = !ferror(archivo);
+    ok = fclose(archivo) == 0 && ok;
+
+    std::error_code error;
+    if (ok) std::filesystem::rename(temporal, ruta, error);
+    if (!ok || error) {
+        std::filesystem::remove(temporal, error);
+        return false;
+    }
+    return true;
+}
+
+static bool leerInforme(const std::string& ruta, InformeFragmento& informe) {
+    std::ifstream archivo(ruta);
+    if (!archivo) return false;
+    informe = InformeFragmento();
+    bool conEstado = false, conSecuencia = false, conFragmento = false;
+    std::string linea;
+    while (std::getline(archivo, linea)) {
+        size_t espacio = linea.find(' ');
+        if (espacio == std::string::npos) continue;
+        std::string clave = linea.substr(0, espacio);
+        const char* valor = linea.c_str() + espacio + 1;
+        if (clave == "fragmento") {
+            conFragmento = sscanf(valor, "%d/%d", &informe.indice, &informe.total) == 2 &&
+                           informe.indice >= 1 && informe.indice <= informe.total &&
+                           informe.total <= MAX_FRAGMENTOS;
+        } else if (clave == "caso") {
+            unsigned long long caso = 0;
+            sscanf(valor, "%llx", &caso);
+            informe.caso = caso;
+        } else if (clave == "profundidad") {
+            informe.profundidad = atoi(valor);
+        } else if (clave == "tareas") {
+            sscanf(valor, "%lld/%lld", &informe.tareasHechas, &informe.tareasPropias);
+        } else if (clave == "estado") {
+            for (int e = FRAGMENTO_EN_CURSO; e <= FRAGMENTO_NINGUNA; ++e) {
+                if (strcmp(valor, NOMBRES_ESTADO[e]) == 0) {
+                    informe.estado = static_cast<EstadoFragmento>(e);
+                    conEstado = true;
+                }
+            }
+        } else if (clave == "tarea") {
+            informe.tarea = atoll(valor);
+        } else if (clave == "secuencia") {
+            conSecuencia = leerSecuencia(valor, informe.secuencia) == informe.profundidad;
+        }
+    }
+    return conFragmento && conEstado &&
+           (informe.estado != FRAGMENTO_ENCONTRADA || conSecuencia);
+}
+
+// ==============================================
+// EJECUCIÓN Y UNIÓN
+// ==============================================
+
+bool ejecutarFragmento(VentanaDispersa& ventana, unsigned char* mask,
+                       unsigned char** maskingDataArray, int profundidad, uint64_t caso,
+                       int indice, int total, int numHilos, const char* directorio,
+                       InformeFragmento& informe) {
+    informe = InformeFragmento();
+    informe.indice = indice;
+    informe.total = total;
+    informe.caso = caso;
+    informe.profundidad = profundidad;
+    informe.tareasPropias = tareasDelFragmento(profundidad, indice - 1, total);
+    informe.estado = FRAGMENTO_EN_CURSO;
+    informe.tarea = -1;
+
+    std::error_code error;
+    std::filesystem::create_directories(directorio, error);
+    if (error || !escribirInforme(directorio, informe)) return false;
+
+    // Un hilo aparte reescribe el avance cada segundo mientras se busca
+    std::atomic<long long> tareasHechas(0);
+    std::mutex mutex;
+    std::condition_variable fin;
+    bool terminado = false;
+    std::thread avance([&] {
+        std::unique_lock<std::mutex> bloqueo(mutex);
+        while (!fin.wait_for(bloqueo, std::chrono::seconds(1), [&] { return terminado; })) {
+            InformeFragmento copia = informe;
+            copia.tareasHechas = tareasHechas.load(std::memory_order_relaxed);
+            bloqueo.unlock();
+            escribirInforme(directorio, copia);
+            bloqueo.lock();
+        }
+    });
+
+    Transformation secuencia[MAX_PASOS];
+    long long tarea;
+    bool encontrada = buscarFragmento(ventana, mask, maskingDataArray, profundidad, indice - 1,
+                                      total, numHilos, secuencia, tarea, &tareasHechas);
+    {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        terminado = true;
+        informe.tareasHechas = tareasHechas.load();
+        informe.estado = encontrada ? FRAGMENTO_ENCONTRADA : FRAGMENTO_NINGUNA;
+        informe.tarea = tarea;
+        if (encontrada) {
+            for (int i = 0; i < profundidad; ++i) informe.secuencia[i] = secuencia[i];
+        }
+    }
+    fin.notify_one();
+    avance.join();
+    return escribirInforme(directorio, informe);
+}
+
+bool unirFragmentos(const char* directorio, uint64_t caso, int profundidad,
+                    Transformation* secuencia, std::string& error) {
+    // Solo cuentan los informes de este caso y esta profundidad; puede haber
+    // restos de otros casos en el mismo directorio
+    std::vector<InformeFragmento> informes;
+    std::error_code errorArchivos;
+    for (const std::filesystem::directory_entry& entrada :
+         std::filesystem::directory_iterator(directorio, errorArchivos)) {
+        std::string nombre = entrada.path().filename().string();
+        if (nombre.compare(0, 10, "fragmento_") != 0 || entrada.path().extension() != ".txt") {
+            continue;
+        }
+        InformeFragmento informe;
+        if (leerInforme(entrada.path().string(), informe) && informe.caso == caso &&
+            informe.profundidad == profundidad) {
+            informes.push_back(informe);
+        }
+    }
+    if (errorArchivos || informes.empty()) {
+        error = std::string("No hay fragmentos de este caso en ") + directorio;
+        return false;
+    }
+
+    int total = informes[0].total;
+    std::vector<const InformeFragmento*> porIndice(total + 1, nullptr);
+    for (const InformeFragmento& informe : informes) {
+        if (informe.total != total) {
+            error = "Hay fragmentos de repartos distintos (de " + std::to_string(total) +
+                    " y de " + std::to_string(informe.total) + ")";
+            return false;
+        }
+        porIndice[informe.indice] = &informe;
+    }
+
+    const InformeFragmento* mejor = nullptr;
+    for (int i = 1; i <= total; ++i) {
+        const InformeFragmento* informe = porIndice[i];
+        std::string nombre = std::to_string(i) + "/" + std::to_string(total);
+        if (!informe) {
+            error = "Falta el fragmento " + nombre;
+            return false;
+        }
+        if (informe->estado == FRAGMENTO_EN_CURSO) {
+            error = "El fragmento " + nombre + " sigue en curso (" +
+                    std::to_string(informe->tareasHechas) + " de " +
+                    std::to_string(informe->tareasPropias) + " tareas)";
+            return false;
+        }
+        if (informe->estado == FRAGMENTO_ENCONTRADA && (!mejor || informe->tarea < mejor->tarea)) {
+            mejor = informe;
+        }
+    }
+    if (!mejor) {
+        error = "Ningun fragmento encontro una secuencia";
+        return false;
+    }
+    for (int i = 0; i < profundidad; ++i) secuencia[i] = mejor->secuencia[i];
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef FRAGMENTOS_H
+#define FRAGMENTOS_H
+
+#include <cstdint>
+#include <string>
+
+#include "busqueda.h"
+
+// ==============================================
+// BÚSQUEDA REPARTIDA ENTRE PROCESOS
+// ==============================================
+// Cada proceso ejecuta un fragmento (ver buscarFragmento) y deja su avance
+// y su resultado en DIRECTORIO/fragmento_<i>_de_<N>.txt; al terminar todos,
+// unirFragmentos elige la secuencia que habría encontrado la búsqueda
+// serial. Los fragmentos no se comunican entre sí, así que pueden correr en
+// el mismo equipo o en varios con un directorio compartido.
+//
+// El archivo es texto, una "clave valor" por línea:
+//
+//   fragmento 2/4
+//   caso 00d7f13bcd096637       claveSecuencia del caso
+//   profundidad 6
+//   tareas 35/148               hechas / del fragmento
+//   estado en_curso             en_curso, encontrada o ninguna
+//   tarea 17                    solo si estado es encontrada
+//   secuencia X,R3,R6,X,R1,X    idem
+
+enum EstadoFragmento { FRAGMENTO_EN_CURSO, FRAGMENTO_ENCONTRADA, FRAGMENTO_NINGUNA };
+
+struct InformeFragmento {
+    int indice;       // de 1 a total
+    int total;
+    uint64_t caso;
+    int profundidad;
+    long long tareasHechas;
+    long long tareasPropias;
+    EstadoFragmento estado;
+    long long tarea;
+    Transformation secuencia[MAX_PASOS];
+};
+
+// Lee "i/N" con 1 <= i <= N <= MAX_FRAGMENTOS
+const int MAX_FRAGMENTOS = 65536;
+bool leerIndiceFragmento(const char* texto, int& indice, int& total);
+
+// Ejecuta el fragmento 'indice' (de 1 a total) sobre la ventana y deja el
+// informe en 'informe' y en su archivo, que se reescribe cada segundo con
+// el avance. Devuelve false si no se pudo escribir el archivo.
+bool ejecutarFragmento(VentanaDispersa& ventana, unsigned char* mask,
+                       unsigned char** maskingDataArray, int profundidad, uint64_t caso,
+                       int indice, int total, int numHilos, const char* directorio,
+                       InformeFragmento& informe);
+
+// Lee los informes de 'directorio' y deja en 'secuencia' la de la menor
+// tarea. Devuelve false con el motivo en 'error' si falta algún fragmento,
+// alguno sigue en curso, son de otro caso o ninguno encontró una secuencia.
+bool unirFragmentos(const char* directorio, uint64_t caso, int profundidad,
+                    Transformation* secuencia, std::string& error);
+
+#endif // FRAGMENTOS_H
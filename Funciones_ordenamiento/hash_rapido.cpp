@@ -0,0 +1,132 @@
+#include "hash_rapido.h"
+
+#include <cstring>
+
+static const uint64_t PRIMO1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIMO2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIMO3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIMO4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIMO5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t rotarIzq64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Lecturas little-endian independientes de la plataforma
+static uint64_t leer64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint32_t leer32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint64_t ronda(uint64_t acumulador, uint64_t entrada) {
+    acumulador += entrada * PRIMO2;
+    acumulador = rotarIzq64(acumulador, 31);
+    return acumulador * PRIMO1;
+}
+
+static uint64_t mezclar(uint64_t acumulador, uint64_t valor) {
+    acumulador ^= ronda(0, valor);
+    return acumulador * PRIMO1 + PRIMO4;
+}
+
+// Procesa los bytes finales (menos de 32) y la avalancha final
+static uint64_t terminar(uint64_t h, const unsigned char* p, size_t resto) {
+    while (resto >= 8) {
+        h ^= ronda(0, leer64(p));
+        h = rotarIzq64(h, 27) * PRIMO1 + PRIMO4;
+        p += 8;
+        resto -= 8;
+    }
+    if (resto >= 4) {
+        h ^= static_cast<uint64_t>(leer32(p)) * PRIMO1;
+        h = rotarIzq64(h, 23) * PRIMO2 + PRIMO3;
+        p += 4;
+        resto -= 4;
+    }
+    while (resto > 0) {
+        h ^= (*p) * PRIMO5;
+        h = rotarIzq64(h, 11) * PRIMO1;
+        ++p;
+        --resto;
+    }
+    h ^= h >> 33;
+    h *= PRIMO2;
+    h ^= h >> 29;
+    h *= PRIMO3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t combinarAcumuladores(const uint64_t* v) {
+    uint64_t h = rotarIzq64(v[0], 1) + rotarIzq64(v[1], 7) +
+                 rotarIzq64(v[2], 12) + rotarIzq64(v[3], 18);
+    for (int i = 0; i < 4; ++i) h = mezclar(h, v[i]);
+    return h;
+}
+
+void iniciarXXH64(EstadoXXH64& estado, uint64_t semilla) {
+    estado.semilla = semilla;
+    estado.acumuladores[0] = semilla + PRIMO1 + PRIMO2;
+    estado.acumuladores[1] = semilla + PRIMO2;
+    estado.acumuladores[2] = semilla;
+    estado.acumuladores[3] = semilla - PRIMO1;
+    estado.total = 0;
+    estado.usados = 0;
+}
+
+static void procesarBloques(uint64_t* v, const unsigned char*& p, const unsigned char* fin) {
+    while (p + 32 <= fin) {
+        v[0] = ronda(v[0], leer64(p));
+        v[1] = ronda(v[1], leer64(p + 8));
+        v[2] = ronda(v[2], leer64(p + 16));
+        v[3] = ronda(v[3], leer64(p + 24));
+        p += 32;
+    }
+}
+
+void actualizarXXH64(EstadoXXH64& estado, const void* datos, size_t tamano) {
+    const unsigned char* p = static_cast<const unsigned char*>(datos);
+    const unsigned char* fin = p + tamano;
+    estado.total += tamano;
+
+    if (estado.usados + tamano < 32) {
+        memcpy(estado.pendiente + estado.usados, p, tamano);
+        estado.usados += tamano;
+        return;
+    }
+    if (estado.usados > 0) {
+        size_t faltan = 32 - estado.usados;
+        memcpy(estado.pendiente + estado.usados, p, faltan);
+        const unsigned char* q = estado.pendiente;
+        procesarBloques(estado.acumuladores, q, estado.pendiente + 32);
+        p += faltan;
+        estado.usados = 0;
+    }
+    procesarBloques(estado.acumuladores, p, fin);
+    estado.usados = static_cast<size_t>(fin - p);
+    memcpy(estado.pendiente, p, estado.usados);
+}
+
+uint64_t finalizarXXH64(const EstadoXXH64& estado) {
+    uint64_t h;
+    if (estado.total >= 32) {
+        h = combinarAcumuladores(estado.acumuladores);
+    } else {
+        h = estado.semilla + PRIMO5;
+    }
+    h += estado.total;
+    return terminar(h, estado.pendiente, estado.usados);
+}
+
+uint64_t xxh64(const void* datos, size_t tamano, uint64_t semilla) {
+    EstadoXXH64 estado;
+    iniciarXXH64(estado, semilla);
+    actualizarXXH64(estado, datos, tamano);
+    return finalizarXXH64(estado);
+}
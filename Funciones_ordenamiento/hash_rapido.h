@@ -0,0 +1,29 @@
+#ifndef HASH_RAPIDO_H
+#define HASH_RAPIDO_H
+
+#include <cstddef>
+#include <cstdint>
+
+// ==============================================
+// HASH RÁPIDO (XXH64)
+// ==============================================
+// Implementación del algoritmo XXH64 de xxHash: produce los mismos valores que
+// la biblioteca de referencia y procesa varios GB/s. Sirve como suma de
+// verificación, no como hash criptográfico.
+
+uint64_t xxh64(const void* datos, size_t tamano, uint64_t semilla = 0);
+
+// Versión incremental para datos que llegan por partes
+struct EstadoXXH64 {
+    uint64_t acumuladores[4];
+    uint64_t semilla;
+    uint64_t total;
+    unsigned char pendiente[32];
+    size_t usados;
+};
+
+void iniciarXXH64(EstadoXXH64& estado, uint64_t semilla = 0);
+void actualizarXXH64(EstadoXXH64& estado, const void* datos, size_t tamano);
+uint64_t finalizarXXH64(const EstadoXXH64& estado);
+
+#endif // HASH_RAPIDO_H
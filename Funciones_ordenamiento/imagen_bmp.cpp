@@ -0,0 +1,171 @@
+#include "imagen_bmp.h"
+
+#include <cstdint>
+#include <cstring>
+
+static const int TAMANO_CABECERA_ARCHIVO = 14;
+static const int TAMANO_CABECERA_INFO = 40;   // BITMAPINFOHEADER
+static const int PIXELES_POR_METRO = 3780;    // 96 ppp, el valor por defecto de Qt
+
+static uint32_t leer32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t leer16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static void escribir32(unsigned char* p, uint32_t v) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+}
+
+static void escribir16(unsigned char* p, uint16_t v) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+}
+
+// Intercambia R y B de una fila (la operación es su propia inversa)
+static void intercambiarRB(unsigned char* destino, const unsigned char* origen, int width) {
+    for (int x = 0; x < width; ++x) {
+        destino[3 * x] = origen[3 * x + 2];
+        destino[3 * x + 1] = origen[3 * x + 1];
+        destino[3 * x + 2] = origen[3 * x];
+    }
+}
+
+// ==============================================
+// LECTURA
+// ==============================================
+
+bool abrirBMP(VistaBMP& vista, const char* ruta) {
+    if (!abrirArchivoMapeado(vista.mapa, ruta)) return false;
+
+    const unsigned char* p = vista.mapa.datos;
+    size_t tamano = vista.mapa.tamano;
+    bool valido = tamano >= static_cast<size_t>(TAMANO_CABECERA_ARCHIVO + TAMANO_CABECERA_INFO) &&
+                  p[0] == 'B' && p[1] == 'M';
+    if (valido) {
+        uint32_t offset = leer32(p + 10);
+        uint32_t tamanoInfo = leer32(p + 14);
+        int32_t ancho = static_cast<int32_t>(leer32(p + 18));
+        int32_t alto = static_cast<int32_t>(leer32(p + 22));
+        uint16_t planos = leer16(p + 26);
+        uint16_t bits = leer16(p + 28);
+        uint32_t compresion = leer32(p + 30);
+
+        // Solo BITMAPINFOHEADER o posteriores (V4/V5), 24 bits, BI_RGB
+        valido = tamanoInfo >= static_cast<uint32_t>(TAMANO_CABECERA_INFO) && planos == 1 &&
+                 bits == 24 && compresion == 0 && ancho > 0 && alto != 0 &&
+                 alto != INT32_MIN;
+        if (valido) {
+            vista.width = ancho;
+            vista.abajoArriba = alto > 0;
+            vista.height = alto > 0 ? alto : -alto;
+            // Con un ancho cercano a INT32_MAX la fila no cabe en un int
+            uint64_t stride = (static_cast<uint64_t>(ancho) * 3 + 3) & ~static_cast<uint64_t>(3);
+            uint64_t necesario = static_cast<uint64_t>(offset) +
+                                 stride * static_cast<uint64_t>(vista.height);
+            valido = stride <= static_cast<uint64_t>(INT32_MAX) && necesario <= tamano;
+            vista.stride = static_cast<int>(stride);
+            vista.pixeles = p + offset;
+        }
+    }
+
+    if (!valido) {
+        cerrarArchivoMapeado(vista.mapa);
+        return false;
+    }
+    return true;
+}
+
+void cerrarBMP(VistaBMP& vista) {
+    cerrarArchivoMapeado(vista.mapa);
+    vista.pixeles = nullptr;
+}
+
+const unsigned char* filaBMP(const VistaBMP& vista, int y) {
+    int guardada = vista.abajoArriba ? vista.height - 1 - y : y;
+    return vista.pixeles + static_cast<size_t>(guardada) * vista.stride;
+}
+
+void copiarFilasRGB(const VistaBMP& vista, int y0, int filas, unsigned char* destino) {
+    for (int y = y0; y < y0 + filas; ++y) {
+        intercambiarRB(destino + static_cast<size_t>(y - y0) * vista.width * 3,
+                       filaBMP(vista, y), vista.width);
+    }
+}
+
+unsigned char byteRGB(const VistaBMP& vista, size_t pos) {
+    size_t bytesFila = static_cast<size_t>(vista.width) * 3;
+    int y = static_cast<int>(pos / bytesFila);
+    size_t columna = pos % bytesFila;
+    // En el archivo cada píxel está en BGR: el canal c está en 2 - c
+    return filaBMP(vista, y)[columna - columna % 3 + 2 - columna % 3];
+}
+
+void descartarFilasBMP(const VistaBMP& vista, int y0, int filas) {
+    if (filas <= 0) return;
+    // Las filas y0..y0+filas-1 ocupan un tramo contiguo del archivo en
+    // cualquiera de las dos orientaciones
+    int primera = vista.abajoArriba ? vista.height - (y0 + filas) : y0;
+    size_t inicio = static_cast<size_t>(vista.pixeles - vista.mapa.datos) +
+                    static_cast<size_t>(primera) * vista.stride;
+    descartarPaginas(vista.mapa, inicio, static_cast<size_t>(filas) * vista.stride);
+}
+
+// ==============================================
+// ESCRITURA
+// ==============================================
+
+bool escribirCabeceraBMP(unsigned char* p, int width, int height) {
+    if (width <= 0 || height <= 0) return false;
+
+    uint64_t stride = (static_cast<uint64_t>(width) * 3 + 3) & ~static_cast<uint64_t>(3);
+    uint64_t tamanoPixeles = stride * static_cast<uint64_t>(height);
+    uint64_t offset = TAMANO_CABECERA_BMP;
+    if (offset + tamanoPixeles > 0xFFFFFFFFULL) return false;   // límite del formato
+    if (stride > static_cast<uint64_t>(INT32_MAX)) return false;   // guardarBMP lo usa como int
+
+    memset(p, 0, TAMANO_CABECERA_BMP);
+    p[0] = 'B';
+    p[1] = 'M';
+    escribir32(p + 2, static_cast<uint32_t>(offset + tamanoPixeles));
+    escribir32(p + 10, static_cast<uint32_t>(offset));
+    escribir32(p + 14, TAMANO_CABECERA_INFO);
+    escribir32(p + 18, static_cast<uint32_t>(width));
+    escribir32(p + 22, static_cast<uint32_t>(height));   // positivo: de abajo hacia arriba
+    escribir16(p + 26, 1);
+    escribir16(p + 28, 24);
+    escribir32(p + 34, static_cast<uint32_t>(tamanoPixeles));
+    escribir32(p + 38, PIXELES_POR_METRO);
+    escribir32(p + 42, PIXELES_POR_METRO);
+    return true;
+}
+
+bool guardarBMP(const char* ruta, const unsigned char* pixelData, int width, int height) {
+    unsigned char cabecera[TAMANO_CABECERA_BMP];
+    if (!escribirCabeceraBMP(cabecera, width, height)) return false;
+
+    int stride = (width * 3 + 3) & ~3;
+    size_t tamano = TAMANO_CABECERA_BMP + static_cast<size_t>(stride) * height;
+    ArchivoMapeado mapa;
+    if (!crearArchivoMapeado(mapa, ruta, tamano)) {
+        return false;
+    }
+    memcpy(mapa.datos, cabecera, TAMANO_CABECERA_BMP);
+
+    unsigned char* pixeles = mapa.datos + TAMANO_CABECERA_BMP;
+    int relleno = stride - width * 3;
+    for (int y = 0; y < height; ++y) {
+        unsigned char* fila = pixeles + static_cast<size_t>(height - 1 - y) * stride;
+        intercambiarRB(fila, pixelData + static_cast<size_t>(y) * width * 3, width);
+        if (relleno > 0) memset(fila + width * 3, 0, relleno);
+    }
+
+    cerrarArchivoMapeado(mapa);
+    return true;
+}
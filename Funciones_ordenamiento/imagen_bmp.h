@@ -0,0 +1,55 @@
+#ifndef IMAGEN_BMP_H
+#define IMAGEN_BMP_H
+
+#include "archivo_mapeado.h"
+
+// ==============================================
+// BMP DE 24 BITS MAPEADO EN MEMORIA
+// ==============================================
+// Lectura y escritura directa de BMP de 24 bits sin compresión, el formato
+// de todas las imágenes del desafío. Las filas del archivo están en BGR,
+// rellenadas a múltiplos de 4 bytes y normalmente guardadas de abajo hacia
+// arriba; las funciones de copia convierten a/desde el RGB sin relleno que
+// usa el resto del programa (el mismo que QImage::Format_RGB888).
+
+struct VistaBMP {
+    ArchivoMapeado mapa;
+    int width;
+    int height;
+    int stride;                    // bytes por fila en el archivo, con relleno
+    bool abajoArriba;              // la primera fila guardada es la inferior
+    const unsigned char* pixeles;  // inicio de los datos de píxeles
+};
+
+// Mapea el archivo y valida la cabecera. Devuelve false si no existe o no es
+// un BMP de 24 bits sin compresión (en ese caso no queda nada abierto).
+bool abrirBMP(VistaBMP& vista, const char* ruta);
+
+void cerrarBMP(VistaBMP& vista);
+
+// Fila y (0 = superior) tal como está en el archivo: width * 3 bytes en BGR.
+const unsigned char* filaBMP(const VistaBMP& vista, int y);
+
+// Copia 'filas' filas desde y0 a 'destino' en RGB sin relleno.
+void copiarFilasRGB(const VistaBMP& vista, int y0, int filas, unsigned char* destino);
+
+// Valor del byte 'pos' de la imagen vista como RGB sin relleno (el mismo
+// índice que en el arreglo de loadPixels), leído directamente del archivo.
+unsigned char byteRGB(const VistaBMP& vista, size_t pos);
+
+// Indica al sistema que las filas [y0, y0 + filas) ya no se van a leer, para
+// que sus páginas no cuenten en la memoria del proceso.
+void descartarFilasBMP(const VistaBMP& vista, int y0, int filas);
+
+// Tamaño de la cabecera que escribe guardarBMP (archivo + BITMAPINFOHEADER)
+const int TAMANO_CABECERA_BMP = 54;
+
+// Escribe en 'cabecera' la cabecera de un BMP de 24 bits de abajo hacia
+// arriba. Devuelve false si la imagen no cabe en el formato (4 GB).
+bool escribirCabeceraBMP(unsigned char* cabecera, int width, int height);
+
+// Guarda una imagen RGB sin relleno como BMP de 24 bits, escribiendo
+// directamente sobre el archivo mapeado.
+bool guardarBMP(const char* ruta, const unsigned char* pixelData, int width, int height);
+
+#endif // IMAGEN_BMP_H
@@ -0,0 +1,50 @@
+#include "imagenes.h"
+
+#include <QImage>
+#include <cstring>
+#include <string>
+
+#include "imagen_bmp.h"
+#include "perfilado.h"
+
+using namespace std;
+
+BufferBytes loadPixels(QString input, int &width, int &height) {
+    MedicionFase medicion(FASE_CARGA_IMAGENES);
+    string ruta = input.toStdString();
+
+    // Camino directo: BMP de 24 bits, sin decodificar ni copiar a un QImage
+    VistaBMP vista;
+    if (abrirBMP(vista, ruta.c_str())) {
+        width = vista.width;
+        height = vista.height;
+        BufferBytes pixelData(static_cast<size_t>(width) * height * 3);
+        copiarFilasRGB(vista, 0, height, pixelData.datos());
+        cerrarBMP(vista);
+        return pixelData;
+    }
+
+    QImage imagen(input);
+    if (imagen.isNull()) return BufferBytes();
+    imagen = imagen.convertToFormat(QImage::Format_RGB888);
+    width = imagen.width();
+    height = imagen.height();
+    BufferBytes pixelData(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        memcpy(pixelData.datos() + static_cast<size_t>(y) * width * 3, imagen.scanLine(y), width * 3);
+    }
+    return pixelData;
+}
+
+bool exportImage(unsigned char* pixelData, int width, int height, QString archivoSalida) {
+    MedicionFase medicion(FASE_EXPORTACION);
+    if (guardarBMP(archivoSalida.toStdString().c_str(), pixelData, width, height)) {
+        return true;
+    }
+
+    QImage outputImage(width, height, QImage::Format_RGB888);
+    for (int y = 0; y < height; ++y) {
+        memcpy(outputImage.scanLine(y), pixelData + static_cast<size_t>(y) * width * 3, width * 3);
+    }
+    return outputImage.save(archivoSalida, "BMP");
+}
@@ -0,0 +1,22 @@
+#ifndef IMAGENES_H
+#define IMAGENES_H
+
+#include <QString>
+
+#include "memoria.h"
+
+// ==============================================
+// CARGA Y EXPORTACIÓN DE IMÁGENES
+// ==============================================
+
+// Carga una imagen como RGB888 sin relleno (width * height * 3 bytes). Los
+// BMP de 24 bits se leen directamente del archivo mapeado; cualquier otro
+// formato pasa por QImage. Devuelve un buffer vacío si no se pudo cargar;
+// avisar del error queda a cargo de quien llama.
+BufferBytes loadPixels(QString input, int &width, int &height);
+
+// Guarda los píxeles RGB888 como BMP de 24 bits escribiendo directamente el
+// archivo; si eso falla se intenta con QImage.
+bool exportImage(unsigned char* pixelData, int width, int height, QString archivoSalida);
+
+#endif // IMAGENES_H
@@ -0,0 +1,243 @@
+#include "lote.h"
+
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "carga_datos.h"
+#include "codificacion.h"
+#include "imagenes.h"
+#include "memoria.h"
+
+// ==============================================
+// CASOS Y COLAS
+// ==============================================
+
+struct CasoLote {
+    std::string directorio;
+    std::string error;   // vacío mientras todo vaya bien
+    int width = 0, height = 0, maskWidth = 0, maskHeight = 0;
+    BufferBytes finalImage, IM, mask;
+    int numTransformations = 0;
+    std::vector<BufferBytes> datosEnmascaramiento;
+    std::vector<unsigned char*> maskingDataArray;
+    std::vector<int> seeds, pixeles;   // pixeles: n_pixels de cada M<i>.txt
+    int profundidad = 0;
+    Transformation secuencia[MAX_PASOS];
+    std::unique_ptr<unsigned char[]> resultado;
+};
+
+// Cola acotada entre dos etapas: poner espera mientras está llena y sacar
+// mientras está vacía. Cuando terminan todos sus productores, sacar devuelve
+// nullptr una vez vacía.
+class ColaCasos {
+public:
+    ColaCasos(size_t capacidad, int productores)
+        : capacidad(capacidad > 0 ? capacidad : 1), productores(productores) {}
+
+    void poner(std::unique_ptr<CasoLote> caso) {
+        std::unique_lock<std::mutex> bloqueo(mutex);
+        noLlena.wait(bloqueo, [this] { return casos.size() < capacidad; });
+        casos.push_back(std::move(caso));
+        noVacia.notify_one();
+    }
+
+    std::unique_ptr<CasoLote> sacar() {
+        std::unique_lock<std::mutex> bloqueo(mutex);
+        noVacia.wait(bloqueo, [this] { return !casos.empty() || productores == 0; });
+        if (casos.empty()) return nullptr;
+        std::unique_ptr<CasoLote> caso = std::move(casos.front());
+        casos.pop_front();
+        noLlena.notify_one();
+        return caso;
+    }
+
+    void productorTermino() {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        if (--productores == 0) noVacia.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable noLlena, noVacia;
+    std::deque<std::unique_ptr<CasoLote>> casos;
+    size_t capacidad;
+    int productores;
+};
+
+// ==============================================
+// ETAPAS
+// ==============================================
+
+static void cargarCaso(CasoLote& caso, const OpcionesBusqueda& opciones) {
+    const std::string& dir = caso.directorio;
+    int widthIM = 0, heightIM = 0;
+    caso.finalImage = loadPixels(QString::fromStdString(dir + "/I_D.bmp"), caso.width, caso.height);
+    caso.IM = loadPixels(QString::fromStdString(dir + "/I_M.bmp"), widthIM, heightIM);
+    caso.mask = loadPixels(QString::fromStdString(dir + "/M.bmp"), caso.maskWidth, caso.maskHeight);
+    if (!caso.finalImage || !caso.IM || !caso.mask) {
+        caso.error = "Error al cargar imágenes requeridas";
+        return;
+    }
+    if (caso.width != widthIM || caso.height != heightIM) {
+        caso.error = "I_D.bmp e I_M.bmp no tienen el mismo tamaño";
+        return;
+    }
+
+    caso.numTransformations = cargarArchivosEnmascaramiento(
+        dir.c_str(), MAX_PASOS - 1, caso.datosEnmascaramiento, caso.seeds, caso.pixeles,
+        caso.error);
+    if (caso.numTransformations == 0) return;
+    // Un enmascaramiento truncado haría leer a la búsqueda fuera de su buffer
+    if (!comprobarEnmascaramientos(caso.pixeles,
+                                   static_cast<size_t>(caso.maskWidth) * caso.maskHeight * 3,
+                                   caso.error)) {
+        return;
+    }
+    caso.profundidad = opciones.profundidad > 0 ? opciones.profundidad
+                                                : caso.numTransformations + 1;
+    for (BufferBytes& datos : caso.datosEnmascaramiento) {
+        caso.maskingDataArray.push_back(datos.datos());
+    }
+}
+
+static void resolverCaso(CasoLote& caso, const OpcionesBusqueda& opciones) {
+    caso.resultado.reset(
+        reconstructImage(caso.finalImage.datos(), caso.IM.datos(), caso.mask.datos(),
+                         caso.width, caso.height, caso.maskWidth, caso.maskHeight,
+                         caso.maskingDataArray.data(), caso.seeds.data(),
+                         caso.numTransformations, caso.secuencia, opciones));
+    if (!caso.resultado) caso.error = "No se pudo reconstruir la imagen";
+
+    // Lo que ya no hace falta se libera antes de esperar turno de escritura
+    caso.finalImage.liberar();
+    caso.IM.liberar();
+    caso.mask.liberar();
+    caso.datosEnmascaramiento.clear();
+    caso.maskingDataArray.clear();
+}
+
+struct EstadoLote {
+    const std::vector<std::string>* directorios;
+    OpcionesBusqueda busqueda;
+    std::atomic<size_t> siguiente;
+    ColaCasos* cargados;
+    ColaCasos* resueltos;
+    std::mutex mutexSalida;
+    int numResueltos;
+};
+
+static void hiloCarga(EstadoLote* estado) {
+    for (;;) {
+        size_t i = estado->siguiente.fetch_add(1);
+        if (i >= estado->directorios->size()) break;
+        std::unique_ptr<CasoLote> caso(new CasoLote);
+        caso->directorio = (*estado->directorios)[i];
+        cargarCaso(*caso, estado->busqueda);
+        estado->cargados->poner(std::move(caso));
+    }
+    estado->cargados->productorTermino();
+}
+
+static void hiloBusqueda(EstadoLote* estado) {
+    while (std::unique_ptr<CasoLote> caso = estado->cargados->sacar()) {
+        if (caso->error.empty()) resolverCaso(*caso, estado->busqueda);
+        estado->resueltos->poner(std::move(caso));
+    }
+    estado->resueltos->productorTermino();
+}
+
+static void hiloEscritura(EstadoLote* estado) {
+    while (std::unique_ptr<CasoLote> caso = estado->resueltos->sacar()) {
+        std::string ruta = caso->directorio + "/reconstructed.bmp";
+        if (caso->error.empty() &&
+            !exportImage(caso->resultado.get(), caso->width, caso->height,
+                         QString::fromStdString(ruta))) {
+            caso->error = "Error al escribir: " + ruta;
+        }
+        caso->resultado.reset();
+
+        std::lock_guard<std::mutex> bloqueo(estado->mutexSalida);
+        if (caso->error.empty()) {
+            char texto[MAX_PASOS * 4 + 1];
+            escribirSecuencia(caso->secuencia, caso->profundidad, texto, sizeof(texto));
+            std::cout << caso->directorio << ": " << texto << std::endl;
+            ++estado->numResueltos;
+        } else {
+            std::cerr << caso->directorio << ": " << caso->error << std::endl;
+        }
+    }
+}
+
+// ==============================================
+// LOTE COMPLETO
+// ==============================================
+
+bool leerListaCasos(const char* ruta, std::vector<std::string>& directorios) {
+    directorios.clear();
+    std::error_code error;
+    if (std::filesystem::is_directory(ruta, error)) {
+        for (const std::filesystem::directory_entry& entrada :
+             std::filesystem::directory_iterator(ruta, error)) {
+            if (entrada.is_directory(error) &&
+                std::filesystem::exists(entrada.path() / "I_D.bmp", error)) {
+                directorios.push_back(entrada.path().string());
+            }
+        }
+        std::sort(directorios.begin(), directorios.end());
+    } else {
+        std::ifstream lista(ruta);
+        std::string linea;
+        while (std::getline(lista, linea)) {
+            while (!linea.empty() && (linea.back() == '\r' || linea.back() == ' ')) linea.pop_back();
+            if (!linea.empty() && linea[0] != '#') directorios.push_back(linea);
+        }
+    }
+    return !directorios.empty();
+}
+
+ResultadoLote procesarLote(const std::vector<std::string>& directorios,
+                           const OpcionesLote& opciones) {
+    int hilosBusqueda = opciones.hilosBusqueda;
+    if (hilosBusqueda <= 0) hilosBusqueda = static_cast<int>(std::thread::hardware_concurrency());
+    if (hilosBusqueda <= 0) hilosBusqueda = 1;
+    int hilosCarga = opciones.hilosCarga > 0 ? opciones.hilosCarga : 1;
+    int hilosEscritura = opciones.hilosEscritura > 0 ? opciones.hilosEscritura : 1;
+
+    // Los cargadores van como mucho un caso por hilo de búsqueda por delante
+    ColaCasos cargados(hilosBusqueda, hilosCarga);
+    ColaCasos resueltos(hilosEscritura, hilosBusqueda);
+
+    EstadoLote estado;
+    estado.directorios = &directorios;
+    estado.busqueda = opciones.busqueda;
+    estado.busqueda.numHilos = 1;
+    estado.siguiente.store(0);
+    estado.cargados = &cargados;
+    estado.resueltos = &resueltos;
+    estado.numResueltos = 0;
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    std::vector<std::thread> hilos;
+    for (int h = 0; h < hilosCarga; ++h) hilos.emplace_back(hiloCarga, &estado);
+    for (int h = 0; h < hilosBusqueda; ++h) hilos.emplace_back(hiloBusqueda, &estado);
+    for (int h = 0; h < hilosEscritura; ++h) hilos.emplace_back(hiloEscritura, &estado);
+    for (std::thread& hilo : hilos) hilo.join();
+
+    ResultadoLote resultado;
+    resultado.casos = static_cast<int>(directorios.size());
+    resultado.resueltos = estado.numResueltos;
+    resultado.segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return resultado;
+}
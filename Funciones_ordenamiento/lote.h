@@ -0,0 +1,47 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <string>
+#include <vector>
+
+#include "busqueda.h"
+
+// ==============================================
+// RECONSTRUCCIÓN POR LOTES
+// ==============================================
+// Cada caso es un directorio con I_D.bmp, I_M.bmp, M.bmp y M1.txt, M2.txt,
+// ... (los mismos nombres que usa main con un solo caso); la imagen
+// reconstruida se escribe en ese directorio como reconstructed.bmp.
+//
+// Los casos pasan por tres etapas unidas por colas acotadas:
+//   carga     -> lee imágenes y enmascaramientos del caso siguiente
+//   búsqueda  -> reconstructImage, un caso por hilo
+//   escritura -> guarda reconstructed.bmp e informa del resultado
+// Así la lectura y escritura de disco se solapan con la búsqueda, y como
+// mucho hay en memoria unos pocos casos por hilo.
+
+struct OpcionesLote {
+    int hilosCarga = 2;
+    int hilosBusqueda = 0;   // 0 = un hilo por núcleo
+    int hilosEscritura = 2;
+    OpcionesBusqueda busqueda;   // numHilos se ignora: cada caso usa un hilo
+};
+
+struct ResultadoLote {
+    int casos = 0;
+    int resueltos = 0;
+    double segundos = 0.0;
+};
+
+// Llena 'directorios' con los casos de 'ruta'. Si es un directorio, sus
+// subdirectorios que tienen I_D.bmp, en orden alfabético; si es un archivo,
+// un directorio por línea (se ignoran las líneas vacías y las que empiezan
+// por #). Devuelve false si la ruta no existe o no tiene casos.
+bool leerListaCasos(const char* ruta, std::vector<std::string>& directorios);
+
+// Reconstruye todos los casos. Los resultados se imprimen a medida que se
+// escriben, que no tiene por qué ser el orden de 'directorios'.
+ResultadoLote procesarLote(const std::vector<std::string>& directorios,
+                           const OpcionesLote& opciones);
+
+#endif // LOTE_H
@@ -1,7 +1,22 @@
-#include <fstream>
+#include <chrono>
 #include <iostream>
-#include <QImage>
-#include <QString>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "busqueda.h"
+#include "carga_asincrona.h"
+#include "cache_secuencias.h"
+#include "carga_datos.h"
+#include "fragmentos.h"
+#include "imagenes.h"
+#include "lote.h"
+#include "operaciones_bits.h"
+#include "perfilado.h"
+#include "reconstruccion_bandas.h"
+#include "servidor.h"
 
 using namespace std;
 
@@ -9,299 +24,463 @@ using namespace std;
 // DECLARACIONES FUNCIONES Y CODIGO
 // ==============================================
 
-enum TransformationType { XOR_OP, ROTATE_RIGHT_OP, ROTATE_LEFT_OP };
-
-struct Transformation {
-    TransformationType type;
-    int bits;
-};
-
-const int MAX_BITS = 8;
-
-// Funciones originales
-unsigned char* loadPixels(QString input, int &width, int &height) {
-    QImage imagen(input);
-    if (imagen.isNull()) {
-        cerr << "Error al cargar: " << input.toStdString() << endl;
-        return nullptr;
-    }
-    imagen = imagen.convertToFormat(QImage::Format_RGB888);
-    width = imagen.width();
-    height = imagen.height();
-    unsigned char* pixelData = new unsigned char[width * height * 3];
-    for (int y = 0; y < height; ++y) {
-        memcpy(pixelData + y * width * 3, imagen.scanLine(y), width * 3);
+// Imprime una secuencia de transformaciones en el orden en que se aplicaron
+void imprimirSecuencia(const Transformation* secuencia, int n) {
+    for (int i = 0; i < n; ++i) {
+        switch (secuencia[i].type) {
+        case XOR_OP:
+            cout << "  " << i + 1 << ". XOR con I_M" << endl;
+            break;
+        case ROTATE_RIGHT_OP:
+            cout << "  " << i + 1 << ". Rotacion derecha " << secuencia[i].bits << " bits" << endl;
+            break;
+        case ROTATE_LEFT_OP:
+            cout << "  " << i + 1 << ". Rotacion izquierda " << secuencia[i].bits << " bits" << endl;
+            break;
+        }
     }
-    return pixelData;
 }
 
-bool exportImage(unsigned char* pixelData, int width, int height, QString archivoSalida) {
-    QImage outputImage(width, height, QImage::Format_RGB888);
-    for (int y = 0; y < height; ++y) {
-        memcpy(outputImage.scanLine(y), pixelData + y * width * 3, width * 3);
+// ==============================================
+// MEDICIÓN DE KERNELS
+// ==============================================
+
+// Imprime el rendimiento en GB/s de applyXOR y applyRotation para cada
+// nivel SIMD que soporte la CPU.
+void imprimirRendimientoKernels() {
+    cout << "Nivel SIMD detectado: " << nombreNivelSIMD(detectarNivelSIMD()) << endl;
+    for (int n = SIMD_ESCALAR; n <= detectarNivelSIMD(); ++n) {
+        NivelSIMD nivel = static_cast<NivelSIMD>(n);
+        cout << nombreNivelSIMD(nivel)
+             << "\tXOR: " << medirRendimientoKernel(KERNEL_XOR, nivel, 64) << " GB/s"
+             << "\tRotacion: " << medirRendimientoKernel(KERNEL_ROTACION, nivel, 64) << " GB/s"
+             << "\tVerificacion: " << medirRendimientoKernel(KERNEL_VERIFICACION, nivel, 64)
+             << " GB/s" << endl;
     }
-    return outputImage.save(archivoSalida, "BMP");
 }
 
-unsigned int* loadSeedMasking(const char* nombreArchivo, int &seed, int &n_pixels) {
-    ifstream archivo(nombreArchivo);
-    if (!archivo.is_open()) {
-        cerr << "Error al abrir: " << nombreArchivo << endl;
-        return nullptr;
-    }
-    archivo >> seed;
-    n_pixels = 0;
-    int r, g, b;
-    while (archivo >> r >> g >> b) n_pixels++;
-
-    archivo.close();
-    archivo.open(nombreArchivo);
-    archivo >> seed;
-
-    unsigned int* data = new unsigned int[n_pixels * 3];
-    for (int i = 0; i < n_pixels * 3; i += 3) {
-        archivo >> data[i] >> data[i+1] >> data[i+2];
+// Tiempo de la búsqueda (sin cargar ni exportar) con 1, 2, 4, ... hasta
+// maxHilos hilos.
+void imprimirEscalado(unsigned char* finalImage, unsigned char* IM, unsigned char* mask,
+                      size_t imgSize, int maskSize, unsigned char** maskingDataArray,
+                      int* seeds, int numTransformations, int profundidad, int maxHilos) {
+    if (maxHilos <= 0) maxHilos = static_cast<int>(thread::hardware_concurrency());
+    if (maxHilos <= 0) maxHilos = 1;
+
+    VentanaDispersa ventana;
+    crearVentanaDispersa(ventana, finalImage, IM, imgSize, seeds,
+                         numTransformations, maskSize);
+    Transformation secuencia[MAX_PASOS];
+    double base = 0.0;
+    for (int hilos = 1; ; hilos = hilos * 2 > maxHilos && hilos < maxHilos ? maxHilos : hilos * 2) {
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+        buscarSecuenciaParalela(ventana, mask, maskingDataArray, profundidad,
+                                hilos, secuencia);
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        if (hilos == 1) base = segundos;
+        cout << "Hilos: " << hilos << "\tTiempo: " << segundos * 1000.0 << " ms"
+             << "\tAceleracion: " << (segundos > 0.0 ? base / segundos : 0.0) << "x" << endl;
+        if (hilos >= maxHilos) break;
     }
-    archivo.close();
-    return data;
+    liberarVentanaDispersa(ventana);
 }
 
-// Operaciones a nivel de bit
-void applyXOR(unsigned char* image1, unsigned char* image2, int size);
+// ==============================================
+// RECONSTRUCCIÓN POR BANDAS
+// ==============================================
 
-unsigned char rotateRight(unsigned char value, int bits);
+// Paso en el que falló reconstruirPorBandas
+enum ResultadoBandas {
+    BANDAS_OK,
+    BANDAS_ERROR_LECTURA,     // I_D.bmp o I_M.bmp no es un BMP de 24 bits
+    BANDAS_TAMANO_DISTINTO,
+    BANDAS_SIN_SOLUCION,
+    BANDAS_SECUENCIA_INVALIDA,  // la secuencia encontrada no se pudo compilar
+    BANDAS_ERROR_ESCRITURA
+};
 
-unsigned char rotateLeft(unsigned char value, int bits);
+// Reconstruye sin cargar I_D ni I_M en memoria: la ventana se toma de los
+// archivos mapeados y la secuencia encontrada se escribe por bandas en
+// reconstructed.bmp.
+ResultadoBandas reconstruirPorBandas(unsigned char* mask, int maskSize,
+                                     unsigned char** maskingDataArray, int* seeds,
+                                     int numTransformations, const OpcionesBusqueda& opciones,
+                                     size_t memoria, Transformation* secuencia) {
+    VistaBMP imagen, IM;
+    if (!abrirBMP(imagen, "I_D.bmp")) {
+        cerr << "Error al cargar: I_D.bmp (se necesita un BMP de 24 bits)" << endl;
+        return BANDAS_ERROR_LECTURA;
+    }
+    if (!abrirBMP(IM, "I_M.bmp")) {
+        cerr << "Error al cargar: I_M.bmp (se necesita un BMP de 24 bits)" << endl;
+        cerrarBMP(imagen);
+        return BANDAS_ERROR_LECTURA;
+    }
 
-void applyRotation(unsigned char* image, int size, int bits, bool right);
+    ResultadoBandas resultado = BANDAS_OK;
+    VentanaDispersa ventana;
+    if (!crearVentanaDesdeBMP(ventana, imagen, IM, seeds, numTransformations, maskSize)) {
+        cerr << "I_D.bmp e I_M.bmp no tienen el mismo tamaño" << endl;
+        resultado = BANDAS_TAMANO_DISTINTO;
+    } else {
+        int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+        ProgramaInverso programa;
+        bool valida = buscarSecuenciaConCache(ventana, mask, maskingDataArray, numTransformations,
+                                              opciones, secuencia);
+        liberarVentanaDispersa(ventana);
+        if (!valida) {
+            cerr << "No se pudo reconstruir la imagen: ninguna secuencia reproduce los "
+                    "enmascaramientos" << endl;
+            resultado = BANDAS_SIN_SOLUCION;
+        } else if (!compilarInversa(secuencia, profundidad, programa)) {
+            cerr << "No se pudo compilar la inversa de la secuencia encontrada" << endl;
+            resultado = BANDAS_SECUENCIA_INVALIDA;
+        } else if (!escribirInversaEnBandas(programa, imagen, IM, "reconstructed.bmp", memoria)) {
+            cerr << "Error al escribir: reconstructed.bmp" << endl;
+            resultado = BANDAS_ERROR_ESCRITURA;
+        }
+    }
 
-// Verificación enmascaramiento
+    cerrarBMP(imagen);
+    cerrarBMP(IM);
+    return resultado;
+}
 
-bool verifyMasking(unsigned char* image, unsigned char* mask,
-                   int imgWidth, int imgHeight,
-                   int maskWidth, int maskHeight,
-                   int seed, unsigned int* maskingData) {
-    int imgSize = imgWidth * imgHeight * 3;
-    int maskSize = maskWidth * maskHeight * 3;
+// ==============================================
+// PERFILADO
+// ==============================================
 
-    for (int k = 0; k < maskSize; ++k) {
-        int pos = (seed + k) % imgSize;
-        unsigned char sum = image[pos] + mask[k % maskSize];
-        if (sum != maskingData[k]) {
-            return false;
-        }
+// Escribe el informe de perfilado en texto por la salida estándar o, si se
+// dio una ruta, en JSON en ese archivo.
+void escribirPerfil(const char* rutaJson) {
+    if (!rutaJson) {
+        escribirInformePerfil(stdout, false);
+        return;
     }
-    return true;
+    FILE* json = fopen(rutaJson, "w");
+    if (!json) {
+        cerr << "No se pudo escribir el perfil en: " << rutaJson << endl;
+        return;
+    }
+    escribirInformePerfil(json, true);
+    fclose(json);
 }
 
 // ==============================================
-// RECONSTRUCCIÓN DE IMAGEN
+// RECONSTRUCCIÓN POR LOTES
 // ==============================================
 
-unsigned char* applyInverseTransformations(unsigned char* finalImage,
-                                           unsigned char* IM,
-                                           const Transformation* transformations,
-                                           int numTransformations,
-                                           int width, int height) {
-    int size = width * height * 3;
-    unsigned char* current = new unsigned char[size];
-    memcpy(current, finalImage, size);
-
-    // Aplicar en orden inverso
-    for (int i = numTransformations - 1; i >= 0; --i) {
-        switch (transformations[i].type) {
-        case XOR_OP:
-            applyXOR(current, IM, size);
-            break;
-        case ROTATE_RIGHT_OP:
-            // Para revertir rotación derecha, aplicamos rotación izquierda
-            applyRotation(current, size, transformations[i].bits, false);
-            break;
-        case ROTATE_LEFT_OP:
-            // Para revertir rotación izquierda, aplicamos rotación derecha
-            applyRotation(current, size, transformations[i].bits, true);
-            break;
-        }
+// Reconstruye todos los casos de 'ruta' (directorio o lista, ver lote.h) con
+// 'hilosBusqueda' casos a la vez y 'hilosES' hilos de carga y otros tantos
+// de escritura (0 = los valores por defecto).
+int reconstruirLote(const char* ruta, const OpcionesBusqueda& opciones,
+                    int hilosBusqueda, int hilosES) {
+    vector<string> directorios;
+    if (!leerListaCasos(ruta, directorios)) {
+        cerr << "No se encontraron casos en: " << ruta << endl;
+        return 1;
+    }
+    OpcionesLote opcionesLote;
+    opcionesLote.busqueda = opciones;
+    opcionesLote.hilosBusqueda = hilosBusqueda;
+    if (hilosES > 0) {
+        opcionesLote.hilosCarga = hilosES;
+        opcionesLote.hilosEscritura = hilosES;
     }
-    return current;
-}
 
-void generatePossibleTransformations(Transformation* transforms, int& count) {
-    // Generar todas las transformaciones posibles
-    count = 0;
+    ResultadoLote resultado = procesarLote(directorios, opcionesLote);
+    cout << "Casos: " << resultado.casos << "\tResueltos: " << resultado.resueltos
+         << "\tTiempo: " << resultado.segundos << " s"
+         << "\tRendimiento: "
+         << (resultado.segundos > 0.0 ? resultado.casos / resultado.segundos : 0.0)
+         << " casos/s" << endl;
+    return resultado.resueltos == resultado.casos ? 0 : 1;
+}
 
-    // XOR
-    transforms[count++] = {XOR_OP, 0};
+// ==============================================
+// BÚSQUEDA REPARTIDA
+// ==============================================
 
-    // Rotaciones derecha (1-8 bits)
-    for (int bits = 1; bits <= MAX_BITS; ++bits) {
-        transforms[count++] = {ROTATE_RIGHT_OP, bits};
+// Ejecuta el fragmento 'indice' de 'total' y deja su informe en 'directorio'
+int ejecutarShard(VentanaDispersa& ventana, unsigned char* mask, unsigned char** maskingDataArray,
+                  int profundidad, int numHilos, int indice, int total, const char* directorio) {
+    uint64_t caso = claveSecuencia(ventana, mask, maskingDataArray, profundidad);
+    InformeFragmento informe;
+    if (!ejecutarFragmento(ventana, mask, maskingDataArray, profundidad, caso, indice, total,
+                           numHilos, directorio, informe)) {
+        cerr << "Error al escribir el informe del fragmento en: " << directorio << endl;
+        return 1;
     }
-
-    // Rotaciones izquierda (1-8 bits)
-    for (int bits = 1; bits <= MAX_BITS; ++bits) {
-        transforms[count++] = {ROTATE_LEFT_OP, bits};
+    cout << "Fragmento " << indice << "/" << total << ": " << informe.tareasHechas
+         << " de " << informe.tareasPropias << " tareas" << endl;
+    if (informe.estado == FRAGMENTO_ENCONTRADA) {
+        cout << "Secuencia en la tarea " << informe.tarea << ":" << endl;
+        imprimirSecuencia(informe.secuencia, profundidad);
+    } else {
+        cout << "Ninguna secuencia en este fragmento" << endl;
     }
+    return 0;
 }
 
-//Verifica si una secuencia específica de transformaciones (en orden inverso)
-// - puede reconstruir correctamente la imagen original.
-//Comprueba si la imagen resultante después de aplicar las transformaciones inversas
-// - coincide con los datos de enmascaramiento guardados en los archivos.
-
-bool testTransformations(unsigned char* finalImage, unsigned char* IM,
-                         unsigned char* mask, int width, int height,
-                         int maskWidth, int maskHeight,
-                         unsigned int** maskingDataArray, int* seeds,
-                         int numTransformations,
-                         const Transformation* candidateTransformations) {
-
-    unsigned char* testImage = applyInverseTransformations(finalImage, IM,
-                                                           candidateTransformations,
-                                                           numTransformations,
-                                                           width, height);
-
-    bool valid = true;
-    for (int i = 0; i < numTransformations; ++i) {
-        if (!verifyMasking(testImage, mask, width, height,
-                           maskWidth, maskHeight,
-                           seeds[i], maskingDataArray[i])) {
-            valid = false;
-            break;
-        }
+// Une los informes de 'directorio' y guarda la secuencia elegida en la caché.
+// La secuencia viene de archivos (un informe viejo o dañado podría tener la
+// misma clave de caso), así que se verifica sobre la ventana antes de usarla.
+bool unirShards(VentanaDispersa& ventana, unsigned char* mask, unsigned char** maskingDataArray,
+                int profundidad, const OpcionesBusqueda& opciones, const char* directorio,
+                Transformation* secuencia) {
+    uint64_t caso = claveSecuencia(ventana, mask, maskingDataArray, profundidad);
+    string error;
+    if (!unirFragmentos(directorio, caso, profundidad, secuencia, error)) {
+        cerr << error << endl;
+        return false;
     }
-
-    delete[] testImage;
-    return valid;
+    if (!verificarPorEtapas(ventana, mask, maskingDataArray, secuencia, profundidad)) {
+        cerr << "La secuencia de los informes de " << directorio
+             << " no reproduce los enmascaramientos" << endl;
+        return false;
+    }
+    if (opciones.cacheSecuencias) {
+        guardarSecuenciaCacheada(opciones.cacheSecuencias, caso, secuencia, profundidad);
+    }
+    return true;
 }
 
-unsigned char* reconstructImage(unsigned char* finalImage, unsigned char* IM,
-                                unsigned char* mask, int width, int height,
-                                int maskWidth, int maskHeight,
-                                unsigned int** maskingDataArray, int* seeds,
-                                int numTransformations) {
-    // Primero probamos la secuencia conocida del ejemplo
-    Transformation knownSequence[] = {
-        {XOR_OP, 0},
-        {ROTATE_RIGHT_OP, 3},
-        {XOR_OP, 0}
-    };
-
-    if (testTransformations(finalImage, IM, mask, width, height,
-                            maskWidth, maskHeight, maskingDataArray, seeds,
-                            numTransformations, knownSequence)) {
-        return applyInverseTransformations(finalImage, IM, knownSequence,
-                                           3, width, height);
-    }
+// ==============================================
+// FUNCIÓN PRINCIPAL
+// ==============================================
 
-    // Si no funciona, probamos todas las combinaciones posibles
-    const int MAX_TRANSFORMS = 17; // 1 XOR + 8 rot derecha + 8 rot izquierda
-    Transformation possibleTransforms[MAX_TRANSFORMS];
-    int transformCount;
-    generatePossibleTransformations(possibleTransforms, transformCount);
-
-    // Probamos todas las combinaciones de 3 transformaciones
-    for (int i = 0; i < transformCount; ++i) {
-        for (int j = 0; j < transformCount; ++j) {
-            for (int k = 0; k < transformCount; ++k) {
-                Transformation candidate[] = {
-                    possibleTransforms[i],
-                    possibleTransforms[j],
-                    possibleTransforms[k]
-                };
-
-                if (testTransformations(finalImage, IM, mask, width, height,
-                                        maskWidth, maskHeight, maskingDataArray, seeds,
-                                        numTransformations, candidate)) {
-                    return applyInverseTransformations(finalImage, IM, candidate,
-                                                       3, width, height);
-                }
+int main(int argc, char* argv[]) {
+    OpcionesBusqueda opciones;
+    opciones.cacheSecuencias = DIRECTORIO_CACHE_SECUENCIAS;
+    bool medirEscalado = false;
+    bool porBandas = false;
+    size_t memoriaBandas = MEMORIA_BANDAS_POR_DEFECTO;
+    const char* rutaLote = nullptr;
+    const char* rutaSocket = nullptr;
+    size_t memoriaCache = OpcionesServidor().capacidadCache;
+    int indiceFragmento = 0, totalFragmentos = 0;
+    bool unirFragmentosPedido = false;
+    const char* dirFragmentos = "fragmentos";
+    bool hilosIndicados = false;
+    int hilosES = 0;
+    bool perfil = false, perfilHardware = false;
+    const char* rutaPerfil = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--bench-kernels") == 0) {
+            imprimirRendimientoKernels();
+            return 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opciones.numHilos = atoi(argv[++i]);
+            hilosIndicados = true;
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            opciones.profundidad = atoi(argv[++i]);
+            if (opciones.profundidad < 1 || opciones.profundidad > MAX_PASOS) {
+                cerr << "La profundidad debe estar entre 1 y " << MAX_PASOS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--analitico") == 0) {
+            opciones.analitico = true;
+        } else if (strcmp(argv[i], "--escalado") == 0) {
+            medirEscalado = true;
+        } else if (strcmp(argv[i], "--streaming") == 0) {
+            porBandas = true;
+        } else if (strcmp(argv[i], "--memoria") == 0 && i + 1 < argc) {
+            long long megabytes = atoll(argv[++i]);
+            if (megabytes < 1) {
+                cerr << "La memoria debe ser de al menos 1 MB" << endl;
+                return 1;
             }
+            memoriaBandas = static_cast<size_t>(megabytes) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--lote") == 0 && i + 1 < argc) {
+            rutaLote = argv[++i];
+        } else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+            rutaSocket = argv[++i];
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            long long megabytes = atoll(argv[++i]);
+            if (megabytes < 1) {
+                cerr << "La cache debe ser de al menos 1 MB" << endl;
+                return 1;
+            }
+            memoriaCache = static_cast<size_t>(megabytes) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--cache-secuencias") == 0 && i + 1 < argc) {
+            opciones.cacheSecuencias = argv[++i];
+        } else if (strcmp(argv[i], "--sin-cache-secuencias") == 0) {
+            opciones.cacheSecuencias = nullptr;
+        } else if (strcmp(argv[i], "--verificar-secuencias") == 0) {
+            opciones.verificarCache = true;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            if (!leerIndiceFragmento(argv[++i], indiceFragmento, totalFragmentos)) {
+                cerr << "--shard espera i/N con 1 <= i <= N <= " << MAX_FRAGMENTOS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--unir-shards") == 0) {
+            unirFragmentosPedido = true;
+        } else if (strcmp(argv[i], "--dir-shards") == 0 && i + 1 < argc) {
+            dirFragmentos = argv[++i];
+        } else if (strcmp(argv[i], "--hilos-es") == 0 && i + 1 < argc) {
+            hilosES = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perfil") == 0) {
+            perfil = true;
+        } else if (strcmp(argv[i], "--perfil-json") == 0 && i + 1 < argc) {
+            perfil = true;
+            rutaPerfil = argv[++i];
+        } else if (strcmp(argv[i], "--perfil-hw") == 0) {
+            perfil = true;
+            perfilHardware = true;
+        } else {
+            cerr << "Opcion desconocida: " << argv[i] << endl;
+            return 1;
         }
     }
 
-    return nullptr;
-}
-// ==============================================
-
-void applyXOR(unsigned char* img1, unsigned char* img2, int size) {
-    for (int i = 0; i < size; ++i) {
-        img1[i] ^= img2[i];
+    if (porBandas && medirEscalado) {
+        cerr << "--escalado necesita las imagenes completas y no se puede usar con --streaming" << endl;
+        return 1;
     }
-}
-
-unsigned char rotateRight(unsigned char value, int bits) {
-    bits = bits % MAX_BITS;
-    return (value >> bits) | (value << (MAX_BITS - bits));
-}
 
-unsigned char rotateLeft(unsigned char value, int bits) {
-    bits = bits % MAX_BITS;
-    return (value << bits) | (value >> (MAX_BITS - bits));
-}
+    if (perfil) {
+        if (perfilHardware && !iniciarContadoresHardware()) {
+            cerr << "Contadores de hardware no disponibles (ver perf_event_paranoid)" << endl;
+        }
+        activarPerfilado(true);
+    }
 
-void applyRotation(unsigned char* img, int size, int bits, bool right) {
-    for (int i = 0; i < size; ++i) {
-        img[i] = right ? rotateRight(img[i], bits) : rotateLeft(img[i], bits);
+    bool fragmentado = indiceFragmento > 0 || unirFragmentosPedido;
+    if (fragmentado && (indiceFragmento > 0) == unirFragmentosPedido) {
+        cerr << "--shard y --unir-shards no se pueden usar juntos" << endl;
+        return 1;
+    }
+    if (fragmentado && (rutaSocket || rutaLote || porBandas)) {
+        cerr << "--shard y --unir-shards no se pueden usar con --servidor, --lote ni --streaming"
+             << endl;
+        return 1;
     }
-}
 
-// ==============================================
-// FUNCIÓN PRINCIPAL
-// ==============================================
+    if (rutaSocket) {
+        if (rutaLote || porBandas || medirEscalado) {
+            cerr << "--servidor no se puede usar con --lote, --streaming ni --escalado" << endl;
+            return 1;
+        }
+        // Los trabajos corren a la vez; --threads es el número de hilos de cada uno
+        OpcionesServidor opcionesServidor;
+        opcionesServidor.rutaSocket = rutaSocket;
+        opcionesServidor.capacidadCache = memoriaCache;
+        opcionesServidor.busqueda = opciones;
+        bool correcto = ejecutarServidor(opcionesServidor);
+        if (perfil) escribirPerfil(rutaPerfil);
+        return correcto ? 0 : 1;
+    }
 
-int main() {
-    // Cargar imágenes
-    int width, height, maskWidth, maskHeight;
-    unsigned char* finalImage = loadPixels("I_D.bmp", width, height);
-    unsigned char* IM = loadPixels("I_M.bmp", width, height);
-    unsigned char* mask = loadPixels("M.bmp", maskWidth, maskHeight);
+    if (rutaLote) {
+        if (porBandas || medirEscalado) {
+            cerr << "--lote no se puede usar con --streaming ni con --escalado" << endl;
+            return 1;
+        }
+        int resultado = reconstruirLote(rutaLote, opciones,
+                                        hilosIndicados ? opciones.numHilos : 0, hilosES);
+        if (perfil) escribirPerfil(rutaPerfil);
+        return resultado;
+    }
 
-    if (!finalImage || !IM || !mask) {
-        cerr << "Error al cargar imágenes requeridas" << endl;
+    // Contar los archivos de enmascaramiento: M1.txt, M2.txt, ... hasta el
+    // primero que no exista
+    int numTransformations = contarArchivosEnmascaramiento("", MAX_PASOS - 1);
+    if (numTransformations == 0) {
+        cerr << "No se encontro M1.txt" << endl;
+        return 1;
+    }
+    int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+    cout << "Archivos de enmascaramiento: " << numTransformations
+         << "\tProfundidad: " << profundidad
+         << "\tSecuencias canonicas: " << contarSecuenciasCanonicas(profundidad, numTransformations)
+         << endl;
+
+    // Todas las lecturas a la vez. I_D e I_M completas solo hacen falta para
+    // la inversa final (por bandas ni eso, y un fragmento tampoco)
+    CargaAsincrona carga;
+    iniciarCargaAsincrona(carga, "", numTransformations, !porBandas && indiceFragmento == 0);
+    ImagenCargada mask;
+    vector<BufferBytes> datosEnmascaramiento;
+    vector<int> seeds;
+    string error;
+    if (!esperarEnmascaramiento(carga, mask, datosEnmascaramiento, seeds, error)) {
+        cerr << error << endl;
         return 1;
     }
+    vector<unsigned char*> maskingDataArray;
+    for (BufferBytes& datos : datosEnmascaramiento) maskingDataArray.push_back(datos.datos());
+    int maskSize = mask.width * mask.height * 3;
 
-    // Cargar datos de enmascaramiento
-    int numTransformations = 2; // M1.txt y M2.txt
-    unsigned int** maskingDataArray = new unsigned int*[numTransformations];
-    int* seeds = new int[numTransformations];
-    int* n_pixels = new int[numTransformations];
-
-    for (int i = 0; i < numTransformations; ++i) {
-        char filename[20];
-        sprintf(filename, "M%d.txt", i+1);
-        maskingDataArray[i] = loadSeedMasking(filename, seeds[i], n_pixels[i]);
-        if (!maskingDataArray[i]) {
-            cerr << "Error al cargar archivo de enmascaramiento: " << filename << endl;
+    if (medirEscalado) {
+        if (!esperarImagenes(carga, error)) {
+            cerr << error << endl;
             return 1;
         }
+        imprimirEscalado(carga.finalImage.pixeles.datos(), carga.IM.pixeles.datos(),
+                         mask.pixeles.datos(),
+                         static_cast<size_t>(carga.finalImage.width) * carga.finalImage.height * 3,
+                         maskSize, maskingDataArray.data(), seeds.data(), numTransformations,
+                         profundidad, opciones.numHilos);
     }
 
     // Reconstruir imagen
-    unsigned char* original = reconstructImage(finalImage, IM, mask, width, height,
-                                               maskWidth, maskHeight, maskingDataArray,
-                                               seeds, numTransformations);
-
-    if (original) {
-        if (exportImage(original, width, height, "reconstructed.bmp")) {
+    Transformation secuencia[MAX_PASOS];
+    if (porBandas) {
+        // reconstruirPorBandas ya informó del paso que falló
+        ResultadoBandas resultado =
+            reconstruirPorBandas(mask.pixeles.datos(), maskSize, maskingDataArray.data(),
+                                 seeds.data(), numTransformations, opciones, memoriaBandas,
+                                 secuencia);
+        if (resultado == BANDAS_OK) {
+            cout << "Secuencia encontrada:" << endl;
+            imprimirSecuencia(secuencia, profundidad);
             cout << "Imagen reconstruida exitosamente!" << endl;
         }
-        delete[] original;
-    } else {
-        cerr << "No se pudo reconstruir la imagen" << endl;
+        if (perfil) escribirPerfil(rutaPerfil);
+        return resultado == BANDAS_OK ? 0 : 1;
     }
 
-    // Liberar memoria
-    delete[] finalImage;
-    delete[] IM;
-    delete[] mask;
-    for (int i = 0; i < numTransformations; ++i) {
-        delete[] maskingDataArray[i];
+    // La búsqueda empieza sobre la ventana mientras I_D e I_M terminan de cargarse
+    VentanaDispersa ventana;
+    if (!crearVentanaAnticipada(carga, seeds.data(), numTransformations, maskSize, ventana,
+                                error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (indiceFragmento > 0) {
+        int resultado = ejecutarShard(ventana, mask.pixeles.datos(), maskingDataArray.data(),
+                                      profundidad, opciones.numHilos, indiceFragmento,
+                                      totalFragmentos, dirFragmentos);
+        liberarVentanaDispersa(ventana);
+        if (perfil) escribirPerfil(rutaPerfil);
+        return resultado;
+    }
+    bool valida = unirFragmentosPedido
+                      ? unirShards(ventana, mask.pixeles.datos(), maskingDataArray.data(),
+                                   profundidad, opciones, dirFragmentos, secuencia)
+                      : buscarSecuenciaConCache(ventana, mask.pixeles.datos(),
+                                                maskingDataArray.data(), numTransformations,
+                                                opciones, secuencia);
+    liberarVentanaDispersa(ventana);
+
+    if (!valida) {
+        if (unirFragmentosPedido) return 1;
+        cerr << "No se pudo reconstruir la imagen" << endl;
+    } else if (!esperarImagenes(carga, error)) {
+        cerr << error << endl;
+        return 1;
+    } else {
+        cout << "Secuencia encontrada:" << endl;
+        imprimirSecuencia(secuencia, profundidad);
+        int width = carga.finalImage.width, height = carga.finalImage.height;
+        unique_ptr<unsigned char[]> original(
+            applyInverseTransformations(carga.finalImage.pixeles.datos(), carga.IM.pixeles.datos(),
+                                        secuencia, profundidad, width, height));
+        if (exportImage(original.get(), width, height, "reconstructed.bmp")) {
+            cout << "Imagen reconstruida exitosamente!" << endl;
+        }
     }
-    delete[] maskingDataArray;
-    delete[] seeds;
-    delete[] n_pixels;
 
+    if (perfil) escribirPerfil(rutaPerfil);
     return 0;
 }
@@ -0,0 +1,175 @@
+#include "memoria.h"
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// ==============================================
+// RESERVA DE BLOQUES
+// ==============================================
+
+static size_t redondearPaginaGrande(size_t tamano) {
+    return (tamano + TAMANO_PAGINA_GRANDE - 1) / TAMANO_PAGINA_GRANDE * TAMANO_PAGINA_GRANDE;
+}
+
+unsigned char* reservarMemoria(size_t tamano) {
+    if (tamano < TAMANO_PAGINA_GRANDE) {
+        return new unsigned char[tamano > 0 ? tamano : 1];
+    }
+
+    size_t total = redondearPaginaGrande(tamano);
+#ifdef _WIN32
+    // Las páginas grandes en Windows necesitan un privilegio que casi nunca
+    // está concedido; se usan páginas normales
+    void* p = VirtualAlloc(nullptr, total, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!p) throw std::bad_alloc();
+#else
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    // Páginas grandes reservadas por el administrador (vm.nr_hugepages)
+    p = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+        p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        // Si no hay reservadas, se piden páginas grandes transparentes
+        madvise(p, total, MADV_HUGEPAGE);
+#endif
+    }
+#endif
+    return static_cast<unsigned char*>(p);
+}
+
+void liberarMemoria(unsigned char* datos, size_t tamano) {
+    if (!datos) return;
+    if (tamano < TAMANO_PAGINA_GRANDE) {
+        delete[] datos;
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(datos, 0, MEM_RELEASE);
+#else
+    munmap(datos, redondearPaginaGrande(tamano));
+#endif
+}
+
+// ==============================================
+// BUFFER DUEÑO
+// ==============================================
+
+BufferBytes::BufferBytes(size_t tamano)
+    : puntero(reservarMemoria(tamano)), bytes(tamano) {
+}
+
+BufferBytes::BufferBytes(BufferBytes&& otro) noexcept
+    : puntero(otro.puntero), bytes(otro.bytes) {
+    otro.puntero = nullptr;
+    otro.bytes = 0;
+}
+
+BufferBytes& BufferBytes::operator=(BufferBytes&& otro) noexcept {
+    if (this != &otro) {
+        liberar();
+        puntero = otro.puntero;
+        bytes = otro.bytes;
+        otro.puntero = nullptr;
+        otro.bytes = 0;
+    }
+    return *this;
+}
+
+void BufferBytes::liberar() {
+    liberarMemoria(puntero, bytes);
+    puntero = nullptr;
+    bytes = 0;
+}
+
+// ==============================================
+// ARENA
+// ==============================================
+
+static const size_t ALINEACION_ARENA = 64;   // una línea de caché
+
+unsigned char* ArenaTemporal::reservar(size_t tamano) {
+    // Primero el bloque actual y luego los que ya existen después de él
+    for (; actual < numBloques; ++actual, usado = 0) {
+        BufferBytes& bloque = bloques[actual];
+        uintptr_t base = reinterpret_cast<uintptr_t>(bloque.datos());
+        size_t inicio = ((base + usado + ALINEACION_ARENA - 1) & ~(ALINEACION_ARENA - 1)) - base;
+        if (inicio + tamano <= bloque.tamano()) {
+            usado = inicio + tamano;
+            return bloque.datos() + inicio;
+        }
+    }
+
+    // Bloque nuevo, al menos el doble del anterior para que sean pocos
+    if (numBloques == MAX_BLOQUES) throw std::bad_alloc();
+    size_t nuevo = TAMANO_PAGINA_GRANDE;
+    if (numBloques > 0 && bloques[numBloques - 1].tamano() * 2 > nuevo) {
+        nuevo = bloques[numBloques - 1].tamano() * 2;
+    }
+    if (tamano + ALINEACION_ARENA > nuevo) nuevo = tamano + ALINEACION_ARENA;
+    bloques[numBloques] = BufferBytes(nuevo);
+    actual = numBloques++;
+    usado = 0;
+    return reservar(tamano);
+}
+
+size_t ArenaTemporal::capacidad() const {
+    size_t total = 0;
+    for (int i = 0; i < numBloques; ++i) total += bloques[i].tamano();
+    return total;
+}
+
+// Arenas de hilos que ya terminaron. No se destruye nunca: un hilo puede
+// devolver la suya mientras el proceso ya está terminando.
+struct ArenasLibres {
+    std::mutex mutex;
+    std::vector<ArenaTemporal*> libres;
+    size_t creadas = 0;
+};
+
+static ArenasLibres& arenasLibres() {
+    static ArenasLibres* arenas = new ArenasLibres;
+    return *arenas;
+}
+
+// Toma una arena guardada (o crea una) y la devuelve al terminar el hilo
+struct ArenaPrestada {
+    ArenaTemporal* arena;
+
+    ArenaPrestada() {
+        ArenasLibres& a = arenasLibres();
+        std::lock_guard<std::mutex> bloqueo(a.mutex);
+        if (a.libres.empty()) {
+            // Lugar para devolverla sin reservar nada desde el destructor
+            a.libres.reserve(a.creadas + 1);
+            arena = new ArenaTemporal;
+            ++a.creadas;
+        } else {
+            arena = a.libres.back();
+            a.libres.pop_back();
+        }
+    }
+
+    ~ArenaPrestada() {
+        arena->volverA({0, 0});
+        ArenasLibres& a = arenasLibres();
+        std::lock_guard<std::mutex> bloqueo(a.mutex);
+        a.libres.push_back(arena);
+    }
+};
+
+ArenaTemporal& arenaDelHilo() {
+    thread_local ArenaPrestada prestada;
+    return *prestada.arena;
+}
@@ -0,0 +1,104 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <cstddef>
+
+// ==============================================
+// MEMORIA PARA IMÁGENES Y BUFFERS TEMPORALES
+// ==============================================
+
+// Los bloques de al menos este tamaño se piden directamente al sistema
+// operativo, en páginas grandes si hay disponibles.
+const size_t TAMANO_PAGINA_GRANDE = 2u * 1024 * 1024;
+
+// Reserva 'tamano' bytes sin inicializar. Los bloques grandes se alinean a
+// página (y a página grande cuando el sistema lo permite); los pequeños van
+// al heap. Lanza std::bad_alloc si no hay memoria, como new[].
+unsigned char* reservarMemoria(size_t tamano);
+
+// Libera un bloque de reservarMemoria; 'tamano' debe ser el mismo.
+void liberarMemoria(unsigned char* datos, size_t tamano);
+
+// Arreglo de bytes dueño de su memoria: se libera solo al salir de ámbito.
+// Se puede mover pero no copiar. Un buffer vacío es falso en un if, así que
+// las funciones de carga lo devuelven vacío para indicar error.
+class BufferBytes {
+public:
+    BufferBytes() : puntero(nullptr), bytes(0) {}
+    explicit BufferBytes(size_t tamano);
+    ~BufferBytes() { liberar(); }
+
+    BufferBytes(BufferBytes&& otro) noexcept;
+    BufferBytes& operator=(BufferBytes&& otro) noexcept;
+    BufferBytes(const BufferBytes&) = delete;
+    BufferBytes& operator=(const BufferBytes&) = delete;
+
+    unsigned char* datos() const { return puntero; }
+    size_t tamano() const { return bytes; }
+    explicit operator bool() const { return puntero != nullptr; }
+
+    void liberar();
+
+private:
+    unsigned char* puntero;
+    size_t bytes;
+};
+
+// ==============================================
+// ARENA DE BUFFERS TEMPORALES
+// ==============================================
+// Asignación por desplazamiento dentro de bloques que se conservan entre
+// usos: tras la primera búsqueda, pedir y devolver buffers temporales no
+// toca el heap ni provoca fallos de página. No es segura entre hilos; cada
+// hilo usa la suya (arenaDelHilo).
+
+class ArenaTemporal {
+public:
+    struct Marca {
+        int bloque;
+        size_t usado;
+    };
+
+    ArenaTemporal() : numBloques(0), actual(0), usado(0) {}
+
+    // Buffer de 'tamano' bytes alineado a 64, válido hasta volver a una
+    // marca anterior. Lanza std::bad_alloc si no hay memoria.
+    unsigned char* reservar(size_t tamano);
+
+    Marca marca() const { return {actual, usado}; }
+
+    // Devuelve todo lo reservado después de la marca (los bloques se
+    // conservan para la próxima vez).
+    void volverA(const Marca& m) { actual = m.bloque; usado = m.usado; }
+
+    // Bytes reservados al sistema entre todos los bloques
+    size_t capacidad() const;
+
+private:
+    static const int MAX_BLOQUES = 32;
+    BufferBytes bloques[MAX_BLOQUES];
+    int numBloques;
+    int actual;
+    size_t usado;
+};
+
+// Arena del hilo que llama. Cuando el hilo termina, su arena (con sus
+// bloques) queda guardada para el próximo hilo que la pida: los hilos de
+// corta vida, como los de cada conexión del servidor, no vuelven a pedir
+// memoria al sistema.
+ArenaTemporal& arenaDelHilo();
+
+// Vuelve a la marca tomada al construirse cuando sale de ámbito.
+class AmbitoArena {
+public:
+    explicit AmbitoArena(ArenaTemporal& a) : arena(a), inicio(a.marca()) {}
+    ~AmbitoArena() { arena.volverA(inicio); }
+    AmbitoArena(const AmbitoArena&) = delete;
+    AmbitoArena& operator=(const AmbitoArena&) = delete;
+
+private:
+    ArenaTemporal& arena;
+    ArenaTemporal::Marca inicio;
+};
+
+#endif // MEMORIA_H
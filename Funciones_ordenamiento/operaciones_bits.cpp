@@ -0,0 +1,365 @@
+#include "operaciones_bits.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#include "memoria.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define OPERACIONES_BITS_X86 1
+#include <immintrin.h>
+#define OBJETIVO(isa) __attribute__((target(isa)))
+#endif
+
+// ==============================================
+// VERSIONES ESCALARES
+// ==============================================
+
+unsigned char rotateRight(unsigned char value, int bits) {
+    bits = bits % MAX_BITS;
+    return (value >> bits) | (value << (MAX_BITS - bits));
+}
+
+unsigned char rotateLeft(unsigned char value, int bits) {
+    bits = bits % MAX_BITS;
+    return (value << bits) | (value >> (MAX_BITS - bits));
+}
+
+// Toda rotación se reduce a una rotación izquierda de 0..7 bits:
+// rotar k a la derecha es lo mismo que rotar 8-k a la izquierda.
+static int rotacionIzquierdaEquivalente(int bits, bool right) {
+    bits = bits % MAX_BITS;
+    return right ? (MAX_BITS - bits) % MAX_BITS : bits;
+}
+
+static void xorEscalar(unsigned char* img1, const unsigned char* img2, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        img1[i] ^= img2[i];
+    }
+}
+
+// Una instancia por cantidad de bits: con IZQ constante el compilador reduce
+// cada byte a una sola instrucción de rotación. IM no se usa; está para que
+// todos los pasos tengan la misma firma (KernelPaso).
+template <int IZQ>
+static void rotarEscalar(unsigned char* img, const unsigned char*, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        img[i] = static_cast<unsigned char>((img[i] << IZQ) | (img[i] >> (MAX_BITS - IZQ)));
+    }
+}
+
+static size_t diferenciaEscalar(const unsigned char* valores, const unsigned char* mask,
+                                const unsigned char* esperado, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (static_cast<unsigned char>(valores[i] + mask[i]) != esperado[i]) return i;
+    }
+    return size;
+}
+
+// ==============================================
+// VERSIONES SIMD (x86)
+// ==============================================
+// No hay desplazamientos de 8 bits en SSE/AVX: se desplaza por palabras de
+// 16 bits y se enmascaran los bits que cruzan de un byte al vecino. Las
+// rotaciones son plantillas sobre la cantidad de bits, así que los
+// desplazamientos y las máscaras son constantes inmediatas.
+
+#ifdef OPERACIONES_BITS_X86
+
+OBJETIVO("sse2")
+static void xorSSE2(unsigned char* img1, const unsigned char* img2, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(img1 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(img2 + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(img1 + i), _mm_xor_si128(a, b));
+    }
+    xorEscalar(img1 + i, img2 + i, size - i);
+}
+
+template <int IZQ>
+OBJETIVO("sse2")
+static void rotarSSE2(unsigned char* img, const unsigned char*, size_t size) {
+    const __m128i mascaraAlta = _mm_set1_epi8(static_cast<char>((0xFF << IZQ) & 0xFF));
+    const __m128i mascaraBaja = _mm_set1_epi8(static_cast<char>(0xFF >> (MAX_BITS - IZQ)));
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(img + i));
+        __m128i alta = _mm_and_si128(_mm_slli_epi16(v, IZQ), mascaraAlta);
+        __m128i baja = _mm_and_si128(_mm_srli_epi16(v, MAX_BITS - IZQ), mascaraBaja);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(img + i), _mm_or_si128(alta, baja));
+    }
+    rotarEscalar<IZQ>(img + i, nullptr, size - i);
+}
+
+OBJETIVO("sse2")
+static size_t diferenciaSSE2(const unsigned char* valores, const unsigned char* mask,
+                             const unsigned char* esperado, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i suma = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(valores + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i)));
+        __m128i iguales = _mm_cmpeq_epi8(
+            suma, _mm_loadu_si128(reinterpret_cast<const __m128i*>(esperado + i)));
+        unsigned distintos = ~static_cast<unsigned>(_mm_movemask_epi8(iguales)) & 0xFFFFu;
+        if (distintos) return i + __builtin_ctz(distintos);
+    }
+    return i + diferenciaEscalar(valores + i, mask + i, esperado + i, size - i);
+}
+
+OBJETIVO("avx2")
+static void xorAVX2(unsigned char* img1, const unsigned char* img2, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(img1 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(img2 + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(img1 + i), _mm256_xor_si256(a, b));
+    }
+    xorEscalar(img1 + i, img2 + i, size - i);
+}
+
+template <int IZQ>
+OBJETIVO("avx2")
+static void rotarAVX2(unsigned char* img, const unsigned char*, size_t size) {
+    const __m256i mascaraAlta = _mm256_set1_epi8(static_cast<char>((0xFF << IZQ) & 0xFF));
+    const __m256i mascaraBaja = _mm256_set1_epi8(static_cast<char>(0xFF >> (MAX_BITS - IZQ)));
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(img + i));
+        __m256i alta = _mm256_and_si256(_mm256_slli_epi16(v, IZQ), mascaraAlta);
+        __m256i baja = _mm256_and_si256(_mm256_srli_epi16(v, MAX_BITS - IZQ), mascaraBaja);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(img + i), _mm256_or_si256(alta, baja));
+    }
+    rotarEscalar<IZQ>(img + i, nullptr, size - i);
+}
+
+OBJETIVO("avx2")
+static size_t diferenciaAVX2(const unsigned char* valores, const unsigned char* mask,
+                             const unsigned char* esperado, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i suma = _mm256_add_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(valores + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i)));
+        __m256i iguales = _mm256_cmpeq_epi8(
+            suma, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(esperado + i)));
+        unsigned distintos = ~static_cast<unsigned>(_mm256_movemask_epi8(iguales));
+        if (distintos) return i + __builtin_ctz(distintos);
+    }
+    return i + diferenciaEscalar(valores + i, mask + i, esperado + i, size - i);
+}
+
+OBJETIVO("avx512f,avx512bw,bmi2")
+static void xorAVX512(unsigned char* img1, const unsigned char* img2, size_t size) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i a = _mm512_loadu_si512(img1 + i);
+        __m512i b = _mm512_loadu_si512(img2 + i);
+        _mm512_storeu_si512(img1 + i, _mm512_xor_si512(a, b));
+    }
+    if (i < size) {
+        // Cola con carga/almacenamiento enmascarado en lugar del bucle escalar
+        __mmask64 m = _bzhi_u64(~0ULL, static_cast<unsigned>(size - i));
+        __m512i a = _mm512_maskz_loadu_epi8(m, img1 + i);
+        __m512i b = _mm512_maskz_loadu_epi8(m, img2 + i);
+        _mm512_mask_storeu_epi8(img1 + i, m, _mm512_xor_si512(a, b));
+    }
+}
+
+template <int IZQ>
+OBJETIVO("avx512f,avx512bw,bmi2")
+static void rotarAVX512(unsigned char* img, const unsigned char*, size_t size) {
+    const __m512i mascaraAlta = _mm512_set1_epi8(static_cast<char>((0xFF << IZQ) & 0xFF));
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i v = _mm512_loadu_si512(img + i);
+        __m512i alta = _mm512_slli_epi16(v, IZQ);
+        __m512i baja = _mm512_srli_epi16(v, MAX_BITS - IZQ);
+        // (alta & mascaraAlta) | (baja & ~mascaraAlta) en una sola instrucción
+        _mm512_storeu_si512(img + i, _mm512_ternarylogic_epi32(mascaraAlta, alta, baja, 0xCA));
+    }
+    if (i < size) {
+        __mmask64 m = _bzhi_u64(~0ULL, static_cast<unsigned>(size - i));
+        __m512i v = _mm512_maskz_loadu_epi8(m, img + i);
+        __m512i alta = _mm512_slli_epi16(v, IZQ);
+        __m512i baja = _mm512_srli_epi16(v, MAX_BITS - IZQ);
+        _mm512_mask_storeu_epi8(img + i, m, _mm512_ternarylogic_epi32(mascaraAlta, alta, baja, 0xCA));
+    }
+}
+
+OBJETIVO("avx512f,avx512bw,bmi2")
+static size_t diferenciaAVX512(const unsigned char* valores, const unsigned char* mask,
+                               const unsigned char* esperado, size_t size) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i suma = _mm512_add_epi8(_mm512_loadu_si512(valores + i), _mm512_loadu_si512(mask + i));
+        __mmask64 distintos = _mm512_cmpneq_epi8_mask(suma, _mm512_loadu_si512(esperado + i));
+        if (distintos) return i + __builtin_ctzll(distintos);
+    }
+    if (i < size) {
+        __mmask64 m = _bzhi_u64(~0ULL, static_cast<unsigned>(size - i));
+        __m512i suma = _mm512_add_epi8(_mm512_maskz_loadu_epi8(m, valores + i),
+                                       _mm512_maskz_loadu_epi8(m, mask + i));
+        __mmask64 distintos =
+            _mm512_mask_cmpneq_epi8_mask(m, suma, _mm512_maskz_loadu_epi8(m, esperado + i));
+        if (distintos) return i + __builtin_ctzll(distintos);
+    }
+    return size;
+}
+
+#endif // OPERACIONES_BITS_X86
+
+// ==============================================
+// DESPACHO EN TIEMPO DE EJECUCIÓN
+// ==============================================
+
+typedef size_t (*KernelDiferencia)(const unsigned char*, const unsigned char*,
+                                   const unsigned char*, size_t);
+
+// pasos[0] es el XOR con IM y pasos[k] la rotación izquierda de k bits
+struct TablaKernels {
+    NivelSIMD nivel;
+    KernelPaso pasos[MAX_BITS];
+    KernelDiferencia diferencia;
+};
+
+#define PASOS_NIVEL(xorNivel, rotarNivel) \
+    {xorNivel, rotarNivel<1>, rotarNivel<2>, rotarNivel<3>, \
+     rotarNivel<4>, rotarNivel<5>, rotarNivel<6>, rotarNivel<7>}
+
+static TablaKernels tablaPara(NivelSIMD nivel) {
+    switch (nivel) {
+#ifdef OPERACIONES_BITS_X86
+    case SIMD_AVX512:
+        return {SIMD_AVX512, PASOS_NIVEL(xorAVX512, rotarAVX512), diferenciaAVX512};
+    case SIMD_AVX2:
+        return {SIMD_AVX2, PASOS_NIVEL(xorAVX2, rotarAVX2), diferenciaAVX2};
+    case SIMD_SSE2:
+        return {SIMD_SSE2, PASOS_NIVEL(xorSSE2, rotarSSE2), diferenciaSSE2};
+#endif
+    default:
+        return {SIMD_ESCALAR, PASOS_NIVEL(xorEscalar, rotarEscalar), diferenciaEscalar};
+    }
+}
+
+NivelSIMD detectarNivelSIMD() {
+#ifdef OPERACIONES_BITS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("bmi2")) {
+        return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_ESCALAR;
+}
+
+// Una tabla fija por nivel; nunca se modifican
+static const TablaKernels& tablaDeNivel(NivelSIMD nivel) {
+    static const TablaKernels tablas[] = {tablaPara(SIMD_ESCALAR), tablaPara(SIMD_SSE2),
+                                          tablaPara(SIMD_AVX2), tablaPara(SIMD_AVX512)};
+    return tablas[nivel];
+}
+
+// Cambiar de nivel solo cambia el puntero, así que un hilo que esté
+// aplicando kernels ve la tabla anterior o la nueva, nunca una a medias
+static std::atomic<const TablaKernels*>& punteroTablaActiva() {
+    static std::atomic<const TablaKernels*> tabla(&tablaDeNivel(detectarNivelSIMD()));
+    return tabla;
+}
+
+static const TablaKernels& tablaActiva() {
+    return *punteroTablaActiva().load(std::memory_order_acquire);
+}
+
+NivelSIMD nivelSIMDActivo() {
+    return tablaActiva().nivel;
+}
+
+bool seleccionarNivelSIMD(NivelSIMD nivel) {
+    if (nivel > detectarNivelSIMD()) return false;
+    punteroTablaActiva().store(&tablaDeNivel(nivel), std::memory_order_release);
+    return true;
+}
+
+const char* nombreNivelSIMD(NivelSIMD nivel) {
+    switch (nivel) {
+    case SIMD_SSE2: return "SSE2";
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+    default: return "escalar";
+    }
+}
+
+void applyXOR(unsigned char* img1, unsigned char* img2, size_t size) {
+    tablaActiva().pasos[0](img1, img2, size);
+}
+
+void applyRotation(unsigned char* img, size_t size, int bits, bool right) {
+    int izq = rotacionIzquierdaEquivalente(bits, right);
+    if (izq != 0) tablaActiva().pasos[izq](img, nullptr, size);
+}
+
+KernelPaso kernelXOR() {
+    return tablaActiva().pasos[0];
+}
+
+KernelPaso kernelRotacionIzquierda(int bits) {
+    return tablaActiva().pasos[bits];
+}
+
+size_t primeraDiferenciaSuma(const unsigned char* valores, const unsigned char* mask,
+                             const unsigned char* esperado, size_t size) {
+    return tablaActiva().diferencia(valores, mask, esperado, size);
+}
+
+// ==============================================
+// MEDICIÓN DE RENDIMIENTO
+// ==============================================
+
+double medirRendimientoKernel(KernelBits kernel, NivelSIMD nivel, int megabytes) {
+    if (nivel > detectarNivelSIMD()) return -1.0;
+    // Se usa la tabla del nivel directamente: la activa no cambia, así que
+    // medir no afecta a búsquedas que estén corriendo en otros hilos
+    const TablaKernels& tabla = tablaDeNivel(nivel);
+
+    size_t size = static_cast<size_t>(megabytes) * 1024 * 1024;
+    BufferBytes bufferA(size), bufferB(size), bufferC;
+    unsigned char* a = bufferA.datos();
+    unsigned char* b = bufferB.datos();
+    for (size_t i = 0; i < size; ++i) {
+        a[i] = static_cast<unsigned char>(i * 31);
+        b[i] = static_cast<unsigned char>(i * 17 + 5);
+    }
+    // La verificación se mide en el peor caso: todo coincide
+    unsigned char* c = nullptr;
+    if (kernel == KERNEL_VERIFICACION) {
+        bufferC = BufferBytes(size);
+        c = bufferC.datos();
+        for (size_t i = 0; i < size; ++i) c[i] = static_cast<unsigned char>(a[i] + b[i]);
+    }
+    // La misma rotación que applyRotation(a, size, 3, true)
+    KernelPaso rotacion = tabla.pasos[rotacionIzquierdaEquivalente(3, true)];
+    volatile size_t resultado = 0;
+    auto ejecutar = [&]() {
+        if (kernel == KERNEL_XOR) tabla.pasos[0](a, b, size);
+        else if (kernel == KERNEL_ROTACION) rotacion(a, nullptr, size);
+        else resultado = tabla.diferencia(a, b, c, size);
+    };
+
+    // Una pasada de calentamiento y luego repeticiones hasta ~0.2 s
+    typedef std::chrono::steady_clock Reloj;
+    int repeticiones = 0;
+    double segundos = 0.0;
+    ejecutar();
+    Reloj::time_point inicio = Reloj::now();
+    do {
+        ejecutar();
+        ++repeticiones;
+        segundos = std::chrono::duration<double>(Reloj::now() - inicio).count();
+    } while (segundos < 0.2);
+
+    return static_cast<double>(size) * repeticiones / segundos / 1e9;
+}
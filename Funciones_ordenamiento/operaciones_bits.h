@@ -0,0 +1,62 @@
+#ifndef OPERACIONES_BITS_H
+#define OPERACIONES_BITS_H
+
+// ==============================================
+// OPERACIONES A NIVEL DE BIT
+// ==============================================
+// Kernels de XOR y rotación sobre buffers de bytes. Cada kernel tiene una
+// versión escalar y versiones SSE2/AVX2/AVX-512; la versión usada se elige en
+// tiempo de ejecución según las capacidades de la CPU. Todas producen
+// exactamente los mismos bytes que la versión escalar. Las rotaciones tienen
+// una instancia por cantidad de bits (1..7), elegida al compilar un
+// programa y no en cada byte ni en cada bloque.
+
+#include <cstddef>
+
+const int MAX_BITS = 8;
+
+enum NivelSIMD { SIMD_ESCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 };
+
+void applyXOR(unsigned char* img1, unsigned char* img2, size_t size);
+
+unsigned char rotateRight(unsigned char value, int bits);
+
+unsigned char rotateLeft(unsigned char value, int bits);
+
+void applyRotation(unsigned char* img, size_t size, int bits, bool right);
+
+// Firma común de un paso: XOR de 'datos' con 'IM', o una rotación de
+// cantidad fija (que ignora IM).
+typedef void (*KernelPaso)(unsigned char* datos, const unsigned char* IM, size_t size);
+
+// Kernels del nivel SIMD activo. 'bits' va de 1 a MAX_BITS - 1.
+KernelPaso kernelXOR();
+KernelPaso kernelRotacionIzquierda(int bits);
+
+// Índice del primer k con (valores[k] + mask[k]) mod 256 != esperado[k], o
+// 'size' si todos coinciden. Compara un vector entero a la vez y sale en el
+// primero que tenga una diferencia.
+size_t primeraDiferenciaSuma(const unsigned char* valores, const unsigned char* mask,
+                             const unsigned char* esperado, size_t size);
+
+// Nivel SIMD más alto soportado por la CPU (y por el compilador)
+NivelSIMD detectarNivelSIMD();
+
+// Nivel SIMD usado actualmente por applyXOR/applyRotation/primeraDiferenciaSuma
+NivelSIMD nivelSIMDActivo();
+
+// Fuerza un nivel concreto para todos los hilos. Devuelve false si la CPU no
+// lo soporta, en cuyo caso no se cambia nada. Se puede llamar mientras otros
+// hilos aplican kernels: cada llamada usa la tabla anterior o la nueva.
+bool seleccionarNivelSIMD(NivelSIMD nivel);
+
+const char* nombreNivelSIMD(NivelSIMD nivel);
+
+enum KernelBits { KERNEL_XOR, KERNEL_ROTACION, KERNEL_VERIFICACION };
+
+// Mide el rendimiento en GB/s de un kernel con el nivel indicado sobre un
+// buffer de 'megabytes' MB. Devuelve un valor negativo si el nivel no está
+// soportado. No cambia el nivel activo.
+double medirRendimientoKernel(KernelBits kernel, NivelSIMD nivel, int megabytes);
+
+#endif // OPERACIONES_BITS_H
@@ -0,0 +1,230 @@
+#include "perfilado.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::atomic<bool> perfiladoGlobal(false);
+
+static const char* NOMBRES_FASES[NUM_FASES] = {
+    "loadPixels", "loadSeedMasking", "busqueda", "applyInverseTransformations", "exportImage"
+};
+
+// ==============================================
+// CONTADORES POR HILO
+// ==============================================
+// Cada hilo suma en su propia copia con load/store relajados (sin bloqueo de
+// bus); el informe lee todas las copias vivas y al terminar un hilo su copia
+// se pasa a los totales.
+
+struct ContadoresHilo;
+
+struct RegistroPerfil {
+    std::mutex mutex;
+    std::vector<ContadoresHilo*> hilos;
+    std::atomic<uint64_t> totales[NUM_CONTADORES] = {};
+    std::atomic<uint64_t> nanosegundosFase[NUM_FASES] = {};
+    std::atomic<uint64_t> llamadasFase[NUM_FASES] = {};
+    std::chrono::steady_clock::time_point inicio;
+    bool iniciado = false;
+};
+
+// Nunca se destruye, para que los hilos que terminan tarde aún puedan
+// volcar sus contadores.
+static RegistroPerfil& registro() {
+    static RegistroPerfil* r = new RegistroPerfil;
+    return *r;
+}
+
+struct ContadoresHilo {
+    std::atomic<uint64_t> valores[NUM_CONTADORES] = {};
+
+    ContadoresHilo() {
+        RegistroPerfil& r = registro();
+        std::lock_guard<std::mutex> bloqueo(r.mutex);
+        r.hilos.push_back(this);
+    }
+    ~ContadoresHilo() {
+        RegistroPerfil& r = registro();
+        std::lock_guard<std::mutex> bloqueo(r.mutex);
+        for (int c = 0; c < NUM_CONTADORES; ++c) {
+            r.totales[c].fetch_add(valores[c].load(std::memory_order_relaxed));
+        }
+        r.hilos.erase(std::find(r.hilos.begin(), r.hilos.end(), this));
+    }
+};
+
+void sumarContadorHilo(ContadorPerfil contador, uint64_t cantidad) {
+    thread_local ContadoresHilo propios;
+    std::atomic<uint64_t>& v = propios.valores[contador];
+    v.store(v.load(std::memory_order_relaxed) + cantidad, std::memory_order_relaxed);
+}
+
+void sumarFase(FasePerfil fase, uint64_t nanosegundos) {
+    RegistroPerfil& r = registro();
+    r.nanosegundosFase[fase].fetch_add(nanosegundos, std::memory_order_relaxed);
+    r.llamadasFase[fase].fetch_add(1, std::memory_order_relaxed);
+}
+
+void activarPerfilado(bool activo) {
+    RegistroPerfil& r = registro();
+    if (activo) {
+        std::lock_guard<std::mutex> bloqueo(r.mutex);
+        if (!r.iniciado) {
+            r.inicio = std::chrono::steady_clock::now();
+            r.iniciado = true;
+        }
+    }
+    perfiladoGlobal.store(activo);
+}
+
+static uint64_t leerContador(ContadorPerfil contador) {
+    RegistroPerfil& r = registro();
+    std::lock_guard<std::mutex> bloqueo(r.mutex);
+    uint64_t total = r.totales[contador].load();
+    for (ContadoresHilo* hilo : r.hilos) total += hilo->valores[contador].load();
+    return total;
+}
+
+// ==============================================
+// CONTADORES DE HARDWARE
+// ==============================================
+
+static const int NUM_CONTADORES_HW = 4;
+static const char* NOMBRES_HW[NUM_CONTADORES_HW] = {
+    "ciclos", "instrucciones", "fallos_cache", "fallos_prediccion"
+};
+static int descriptoresHW[NUM_CONTADORES_HW] = {-1, -1, -1, -1};
+
+bool iniciarContadoresHardware() {
+#ifdef __linux__
+    const uint64_t eventos[NUM_CONTADORES_HW] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    bool alguno = false;
+    for (int i = 0; i < NUM_CONTADORES_HW; ++i) {
+        if (descriptoresHW[i] >= 0) {
+            alguno = true;
+            continue;
+        }
+        perf_event_attr atributos = {};
+        atributos.type = PERF_TYPE_HARDWARE;
+        atributos.size = sizeof(atributos);
+        atributos.config = eventos[i];
+        atributos.inherit = 1;          // incluye los hilos creados después
+        atributos.exclude_kernel = 1;   // permitido con perf_event_paranoid <= 2
+        atributos.exclude_hv = 1;
+        descriptoresHW[i] = static_cast<int>(
+            syscall(SYS_perf_event_open, &atributos, 0, -1, -1, 0));
+        alguno = alguno || descriptoresHW[i] >= 0;
+    }
+    return alguno;
+#else
+    return false;
+#endif
+}
+
+static bool leerContadorHardware(int i, uint64_t& valor) {
+#ifdef __linux__
+    if (descriptoresHW[i] < 0) return false;
+    return read(descriptoresHW[i], &valor, sizeof(valor)) == static_cast<ssize_t>(sizeof(valor));
+#else
+    (void)i;
+    (void)valor;
+    return false;
+#endif
+}
+
+// ==============================================
+// INFORME
+// ==============================================
+
+void escribirInformePerfil(FILE* salida, bool json) {
+    RegistroPerfil& r = registro();
+    double total = r.iniciado ? std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - r.inicio).count()
+                              : 0.0;
+    uint64_t candidatos = leerContador(CONTADOR_CANDIDATOS);
+    uint64_t bytesInversa = leerContador(CONTADOR_BYTES_INVERSA);
+    uint64_t verificaciones = leerContador(CONTADOR_VERIFICACIONES);
+    uint64_t fallidas = leerContador(CONTADOR_VERIFICACIONES_FALLIDAS);
+    uint64_t sumaK = leerContador(CONTADOR_K_SALIDA);
+    uint64_t aciertosCache = leerContador(CONTADOR_CACHE_ACIERTOS);
+    uint64_t fallosCache = leerContador(CONTADOR_CACHE_FALLOS);
+    uint64_t invalidasCache = leerContador(CONTADOR_CACHE_INVALIDAS);
+    double kMedio = fallidas > 0 ? static_cast<double>(sumaK) / fallidas : 0.0;
+    double segundosInversa = r.nanosegundosFase[FASE_INVERSA].load() / 1e9;
+
+    if (json) {
+        fprintf(salida, "{\n");
+        fprintf(salida, "  \"formato\": 1,\n");
+        fprintf(salida, "  \"segundos\": %.6f,\n", total);
+        fprintf(salida, "  \"fases\": {\n");
+        for (int f = 0; f < NUM_FASES; ++f) {
+            fprintf(salida, "    \"%s\": {\"llamadas\": %llu, \"segundos\": %.6f}%s\n",
+                    NOMBRES_FASES[f],
+                    static_cast<unsigned long long>(r.llamadasFase[f].load()),
+                    r.nanosegundosFase[f].load() / 1e9, f + 1 < NUM_FASES ? "," : "");
+        }
+        fprintf(salida, "  },\n");
+        fprintf(salida, "  \"candidatos\": %llu,\n", static_cast<unsigned long long>(candidatos));
+        fprintf(salida, "  \"bytes_inversa\": %llu,\n",
+                static_cast<unsigned long long>(bytesInversa));
+        fprintf(salida, "  \"verificaciones\": %llu,\n",
+                static_cast<unsigned long long>(verificaciones));
+        fprintf(salida, "  \"verificaciones_fallidas\": %llu,\n",
+                static_cast<unsigned long long>(fallidas));
+        fprintf(salida, "  \"k_medio_salida\": %.3f,\n", kMedio);
+        fprintf(salida, "  \"cache_secuencias\": {\"aciertos\": %llu, \"fallos\": %llu, "
+                        "\"invalidas\": %llu},\n",
+                static_cast<unsigned long long>(aciertosCache),
+                static_cast<unsigned long long>(fallosCache),
+                static_cast<unsigned long long>(invalidasCache));
+        fprintf(salida, "  \"hardware\": {");
+        bool primero = true;
+        for (int i = 0; i < NUM_CONTADORES_HW; ++i) {
+            uint64_t valor;
+            if (!leerContadorHardware(i, valor)) continue;
+            fprintf(salida, "%s\"%s\": %llu", primero ? "" : ", ", NOMBRES_HW[i],
+                    static_cast<unsigned long long>(valor));
+            primero = false;
+        }
+        fprintf(salida, "}\n");
+        fprintf(salida, "}\n");
+        return;
+    }
+
+    fprintf(salida, "Perfil (%.3f s en total)\n", total);
+    for (int f = 0; f < NUM_FASES; ++f) {
+        fprintf(salida, "  %-28s %8llu llamadas %12.3f ms\n", NOMBRES_FASES[f],
+                static_cast<unsigned long long>(r.llamadasFase[f].load()),
+                r.nanosegundosFase[f].load() / 1e6);
+    }
+    fprintf(salida, "  Candidatos probados: %llu\n", static_cast<unsigned long long>(candidatos));
+    fprintf(salida, "  Bytes reconstruidos: %llu", static_cast<unsigned long long>(bytesInversa));
+    if (segundosInversa > 0.0) fprintf(salida, " (%.2f GB/s)", bytesInversa / segundosInversa / 1e9);
+    fprintf(salida, "\n");
+    fprintf(salida, "  Verificaciones: %llu\tFallidas: %llu\tk medio al salir: %.2f\n",
+            static_cast<unsigned long long>(verificaciones),
+            static_cast<unsigned long long>(fallidas), kMedio);
+    if (aciertosCache + fallosCache > 0) {
+        fprintf(salida, "  Cache de secuencias: %llu aciertos\t%llu fallos\t%llu invalidas\n",
+                static_cast<unsigned long long>(aciertosCache),
+                static_cast<unsigned long long>(fallosCache),
+                static_cast<unsigned long long>(invalidasCache));
+    }
+    for (int i = 0; i < NUM_CONTADORES_HW; ++i) {
+        uint64_t valor;
+        if (leerContadorHardware(i, valor)) {
+            fprintf(salida, "  %-28s %llu\n", NOMBRES_HW[i], static_cast<unsigned long long>(valor));
+        }
+    }
+}
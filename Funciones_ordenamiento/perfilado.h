@@ -0,0 +1,96 @@
+#ifndef PERFILADO_H
+#define PERFILADO_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// ==============================================
+// PERFILADO INTERNO
+// ==============================================
+// Tiempos por fase y contadores del camino crítico, siempre compilados y
+// desactivados hasta llamar a activarPerfilado. Desactivado, cada punto de
+// medición cuesta una lectura atómica y un salto. Activado, los contadores
+// se acumulan por hilo (sin instrucciones atómicas con bloqueo) y se suman
+// al pedir el informe.
+
+enum FasePerfil {
+    FASE_CARGA_IMAGENES,         // loadPixels
+    FASE_CARGA_ENMASCARAMIENTO,  // loadSeedMasking
+    FASE_BUSQUEDA,               // buscarSecuencia
+    FASE_INVERSA,                // applyInverseTransformations
+    FASE_EXPORTACION,            // exportImage
+    NUM_FASES
+};
+
+enum ContadorPerfil {
+    CONTADOR_CANDIDATOS,            // pasos deshechos sobre la ventana dispersa
+    CONTADOR_BYTES_INVERSA,         // bytes de imagen completa reconstruidos
+    CONTADOR_VERIFICACIONES,        // tramos comparados con su enmascaramiento
+    CONTADOR_VERIFICACIONES_FALLIDAS,
+    CONTADOR_K_SALIDA,              // suma del k en que salió cada fallida
+    CONTADOR_CACHE_ACIERTOS,        // secuencias tomadas de la caché de secuencias
+    CONTADOR_CACHE_FALLOS,
+    CONTADOR_CACHE_INVALIDAS,       // aciertos que no pasaron la verificación
+    NUM_CONTADORES
+};
+
+extern std::atomic<bool> perfiladoGlobal;
+
+inline bool perfiladoActivo() {
+    return perfiladoGlobal.load(std::memory_order_relaxed);
+}
+
+// Activa o desactiva la recogida de datos (los ya recogidos se conservan).
+void activarPerfilado(bool activo);
+
+void sumarContadorHilo(ContadorPerfil contador, uint64_t cantidad);
+void sumarFase(FasePerfil fase, uint64_t nanosegundos);
+
+inline void contarPerfil(ContadorPerfil contador, uint64_t cantidad) {
+    if (perfiladoActivo()) sumarContadorHilo(contador, cantidad);
+}
+
+// Registra en verifyMasking y verificarTramo dónde terminó una comparación:
+// 'k' es el índice del primer byte distinto, o maskSize si coincidieron.
+inline void contarVerificacion(size_t k, size_t maskSize) {
+    if (!perfiladoActivo()) return;
+    sumarContadorHilo(CONTADOR_VERIFICACIONES, 1);
+    if (k < maskSize) {
+        sumarContadorHilo(CONTADOR_VERIFICACIONES_FALLIDAS, 1);
+        sumarContadorHilo(CONTADOR_K_SALIDA, k);
+    }
+}
+
+// Suma a la fase el tiempo entre su construcción y su destrucción.
+class MedicionFase {
+public:
+    explicit MedicionFase(FasePerfil f) : fase(f), activa(perfiladoActivo()) {
+        if (activa) inicio = std::chrono::steady_clock::now();
+    }
+    ~MedicionFase() {
+        if (!activa) return;
+        sumarFase(fase, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - inicio).count()));
+    }
+    MedicionFase(const MedicionFase&) = delete;
+    MedicionFase& operator=(const MedicionFase&) = delete;
+
+private:
+    FasePerfil fase;
+    bool activa;
+    std::chrono::steady_clock::time_point inicio;
+};
+
+// Abre contadores de hardware (ciclos, instrucciones, fallos de caché y de
+// predicción de saltos) para el proceso y los hilos que cree a partir de
+// ahora. Solo en Linux; devuelve false si el sistema no los permite (p. ej.
+// perf_event_paranoid), y el informe los omite.
+bool iniciarContadoresHardware();
+
+// Escribe el resumen en texto o en JSON. Las fases que corren en varios
+// hilos a la vez (por ejemplo con --lote) suman el tiempo de todos.
+void escribirInformePerfil(FILE* salida, bool json);
+
+#endif // PERFILADO_H
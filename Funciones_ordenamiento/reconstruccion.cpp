@@ -0,0 +1,221 @@
+#include "reconstruccion.h"
+
+#include <QString>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "carga_datos.h"
+#include "imagenes.h"
+
+struct ContextoReconstruccion {
+    OpcionesBusqueda opciones;
+    // Copias propias (si se pidió copiar o se cargaron de archivo); si no,
+    // IM y mask apuntan a los buffers de quien llama
+    BufferBytes copiaIM, copiaMascara;
+    const unsigned char* IM = nullptr;
+    const unsigned char* mask = nullptr;
+    int width = 0, height = 0;
+    int maskWidth = 0, maskHeight = 0;
+};
+
+const char* textoCodigoReconstruccion(CodigoReconstruccion codigo) {
+    switch (codigo) {
+    case RECONSTRUCCION_OK: return "correcto";
+    case RECONSTRUCCION_ARGUMENTO_INVALIDO: return "argumento inválido";
+    case RECONSTRUCCION_SIN_ENTRADAS: return "el contexto no tiene I_M y M";
+    case RECONSTRUCCION_ERROR_LECTURA: return "no se pudo cargar una entrada";
+    case RECONSTRUCCION_ERROR_ESCRITURA: return "no se pudo escribir la imagen";
+    case RECONSTRUCCION_TAMANO_DISTINTO:
+        return "I_D e I_M no tienen el mismo tamaño o un enmascaramiento no cubre M";
+    case RECONSTRUCCION_SIN_SOLUCION: return "ninguna secuencia reproduce los enmascaramientos";
+    case RECONSTRUCCION_SIN_MEMORIA: return "sin memoria";
+    }
+    return "código desconocido";
+}
+
+ContextoReconstruccion* crearContextoReconstruccion(const OpcionesBusqueda& opciones) {
+    ContextoReconstruccion* contexto = new (std::nothrow) ContextoReconstruccion;
+    if (contexto) contexto->opciones = opciones;
+    return contexto;
+}
+
+void destruirContextoReconstruccion(ContextoReconstruccion* contexto) {
+    delete contexto;
+}
+
+static BufferBytes copiarBuffer(const unsigned char* datos, size_t tamano) {
+    BufferBytes copia(tamano);
+    memcpy(copia.datos(), datos, tamano);
+    return copia;
+}
+
+CodigoReconstruccion fijarEntradas(ContextoReconstruccion* contexto, const unsigned char* IM,
+                                   int width, int height, const unsigned char* mask,
+                                   int maskWidth, int maskHeight, bool copiar) {
+    if (!contexto || !IM || !mask || width <= 0 || height <= 0 || maskWidth <= 0 ||
+        maskHeight <= 0) {
+        return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    }
+    try {
+        BufferBytes copiaIM, copiaMascara;
+        if (copiar) {
+            copiaIM = copiarBuffer(IM, static_cast<size_t>(width) * height * 3);
+            copiaMascara = copiarBuffer(mask, static_cast<size_t>(maskWidth) * maskHeight * 3);
+            IM = copiaIM.datos();
+            mask = copiaMascara.datos();
+        }
+        contexto->copiaIM = std::move(copiaIM);
+        contexto->copiaMascara = std::move(copiaMascara);
+    } catch (const std::bad_alloc&) {
+        return RECONSTRUCCION_SIN_MEMORIA;
+    }
+    contexto->IM = IM;
+    contexto->mask = mask;
+    contexto->width = width;
+    contexto->height = height;
+    contexto->maskWidth = maskWidth;
+    contexto->maskHeight = maskHeight;
+    return RECONSTRUCCION_OK;
+}
+
+CodigoReconstruccion cargarEntradas(ContextoReconstruccion* contexto, const char* rutaIM,
+                                    const char* rutaMascara) {
+    if (!contexto || !rutaIM || !rutaMascara) return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    try {
+        int width, height, maskWidth, maskHeight;
+        BufferBytes IM = loadPixels(QString::fromStdString(rutaIM), width, height);
+        BufferBytes mask = loadPixels(QString::fromStdString(rutaMascara), maskWidth, maskHeight);
+        if (!IM || !mask) return RECONSTRUCCION_ERROR_LECTURA;
+
+        contexto->IM = IM.datos();
+        contexto->mask = mask.datos();
+        contexto->copiaIM = std::move(IM);
+        contexto->copiaMascara = std::move(mask);
+        contexto->width = width;
+        contexto->height = height;
+        contexto->maskWidth = maskWidth;
+        contexto->maskHeight = maskHeight;
+    } catch (const std::bad_alloc&) {
+        return RECONSTRUCCION_SIN_MEMORIA;
+    }
+    return RECONSTRUCCION_OK;
+}
+
+// Reconstrucción con las entradas ya validadas: la misma secuencia de pasos
+// que reconstructImage, pero escribiendo en 'salida'
+static CodigoReconstruccion reconstruirConEntradas(
+    const OpcionesBusqueda& opciones, const unsigned char* finalImage, const unsigned char* IM,
+    int width, int height, const unsigned char* mask, int maskWidth, int maskHeight,
+    const unsigned char* const* maskingDataArray, const int* seeds, int numTransformations,
+    unsigned char* salida, Transformation* secuencia) {
+    int profundidad = opciones.profundidad > 0 ? opciones.profundidad : numTransformations + 1;
+    if (numTransformations < 1 || profundidad > MAX_PASOS) return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    for (int i = 0; i < numTransformations; ++i) {
+        if (!maskingDataArray[i] || seeds[i] < 0) return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    }
+
+    size_t size = static_cast<size_t>(width) * height * 3;
+    Transformation encontrada[MAX_PASOS];
+    bool valida;
+    VentanaDispersa ventana = {};
+    try {
+        // La ventana se copia antes de tocar 'salida', así que puede ser el
+        // mismo buffer que 'finalImage'
+        crearVentanaDispersa(ventana, finalImage, IM, size, seeds, numTransformations,
+                             maskWidth * maskHeight * 3);
+        // La búsqueda solo lee la máscara y los enmascaramientos; las firmas
+        // sin const vienen de la interfaz original
+        valida = buscarSecuenciaConCache(ventana, const_cast<unsigned char*>(mask),
+                                         const_cast<unsigned char**>(maskingDataArray),
+                                         numTransformations, opciones, encontrada);
+    } catch (const std::bad_alloc&) {
+        liberarVentanaDispersa(ventana);
+        return RECONSTRUCCION_SIN_MEMORIA;
+    }
+    liberarVentanaDispersa(ventana);
+    if (!valida) return RECONSTRUCCION_SIN_SOLUCION;
+
+    if (!aplicarInversaEn(salida, finalImage, IM, encontrada, profundidad, size)) {
+        return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    }
+    if (secuencia) {
+        for (int i = 0; i < profundidad; ++i) secuencia[i] = encontrada[i];
+    }
+    return RECONSTRUCCION_OK;
+}
+
+CodigoReconstruccion reconstruirBuffers(const ContextoReconstruccion* contexto,
+                                        const unsigned char* finalImage, int width, int height,
+                                        const unsigned char* const* maskingDataArray,
+                                        const int* seeds, int numTransformations,
+                                        unsigned char* salida, Transformation* secuencia) {
+    if (!contexto || !finalImage || !maskingDataArray || !seeds || !salida) {
+        return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    }
+    if (!contexto->IM) return RECONSTRUCCION_SIN_ENTRADAS;
+    if (width != contexto->width || height != contexto->height) {
+        return RECONSTRUCCION_TAMANO_DISTINTO;
+    }
+    return reconstruirConEntradas(contexto->opciones, finalImage, contexto->IM, width, height,
+                                  contexto->mask, contexto->maskWidth, contexto->maskHeight,
+                                  maskingDataArray, seeds, numTransformations, salida, secuencia);
+}
+
+CodigoReconstruccion reconstruirArchivos(const ContextoReconstruccion* contexto,
+                                         const char* directorio, const char* rutaSalida,
+                                         Transformation* secuencia) {
+    if (!contexto || !directorio || !rutaSalida) return RECONSTRUCCION_ARGUMENTO_INVALIDO;
+    std::string dir = directorio[0] == '\0' ? std::string(".") : std::string(directorio);
+
+    try {
+        int width, height;
+        BufferBytes finalImage =
+            loadPixels(QString::fromStdString(dir + "/I_D.bmp"), width, height);
+        if (!finalImage) return RECONSTRUCCION_ERROR_LECTURA;
+
+        // Sin entradas en el contexto se usan las del caso
+        const unsigned char* IM = contexto->IM;
+        const unsigned char* mask = contexto->mask;
+        int IMWidth = contexto->width, IMHeight = contexto->height;
+        int maskWidth = contexto->maskWidth, maskHeight = contexto->maskHeight;
+        BufferBytes IMCaso, mascaraCaso;
+        if (!IM) {
+            IMCaso = loadPixels(QString::fromStdString(dir + "/I_M.bmp"), IMWidth, IMHeight);
+            mascaraCaso = loadPixels(QString::fromStdString(dir + "/M.bmp"), maskWidth, maskHeight);
+            if (!IMCaso || !mascaraCaso) return RECONSTRUCCION_ERROR_LECTURA;
+            IM = IMCaso.datos();
+            mask = mascaraCaso.datos();
+        }
+        if (IMWidth != width || IMHeight != height) return RECONSTRUCCION_TAMANO_DISTINTO;
+
+        std::vector<BufferBytes> datosEnmascaramiento;
+        std::vector<int> seeds, pixeles;
+        std::string error;
+        int numTransformations = cargarArchivosEnmascaramiento(
+            dir.c_str(), MAX_PASOS - 1, datosEnmascaramiento, seeds, pixeles, error);
+        if (numTransformations == 0) return RECONSTRUCCION_ERROR_LECTURA;
+        // El tamaño del buffer puede ser mayor que lo leído: lo que cuenta es n_pixels
+        if (!comprobarEnmascaramientos(pixeles, static_cast<size_t>(maskWidth) * maskHeight * 3,
+                                       error)) {
+            return RECONSTRUCCION_TAMANO_DISTINTO;
+        }
+        std::vector<const unsigned char*> maskingDataArray;
+        for (BufferBytes& datos : datosEnmascaramiento) maskingDataArray.push_back(datos.datos());
+
+        // I_D ya no hace falta después de la reconstrucción: se reconstruye
+        // sobre su propio buffer
+        CodigoReconstruccion codigo = reconstruirConEntradas(
+            contexto->opciones, finalImage.datos(), IM, width, height, mask, maskWidth,
+            maskHeight, maskingDataArray.data(), seeds.data(), numTransformations,
+            finalImage.datos(), secuencia);
+        if (codigo != RECONSTRUCCION_OK) return codigo;
+        if (!exportImage(finalImage.datos(), width, height, QString::fromStdString(rutaSalida))) {
+            return RECONSTRUCCION_ERROR_ESCRITURA;
+        }
+    } catch (const std::bad_alloc&) {
+        return RECONSTRUCCION_SIN_MEMORIA;
+    }
+    return RECONSTRUCCION_OK;
+}
@@ -0,0 +1,92 @@
+#ifndef RECONSTRUCCION_H
+#define RECONSTRUCCION_H
+
+#include "busqueda.h"
+
+// ==============================================
+// BIBLIOTECA DE RECONSTRUCCIÓN
+// ==============================================
+// Interfaz para usar la reconstrucción desde otro programa sin lanzar un
+// proceso por trabajo (ver Reconstruccion.pro). Nada de lo que está aquí
+// escribe en la consola: todo informa con un CodigoReconstruccion.
+//
+// Un ContextoReconstruccion guarda las opciones de búsqueda y las entradas
+// que comparten los trabajos: I_M y M. Cada trabajo trae su I_D y sus
+// enmascaramientos. La memoria de trabajo de la búsqueda sale de la arena de
+// cada hilo y se reutiliza entre llamadas.
+//
+// Hilos: reconstruirBuffers y reconstruirArchivos se pueden llamar a la vez
+// desde varios hilos, con el mismo contexto o con otros. fijarEntradas y
+// cargarEntradas modifican el contexto y no deben coincidir con ningún
+// trabajo sobre él.
+
+#if defined(_WIN32) && defined(RECONSTRUCCION_COMPARTIDA)
+#  ifdef RECONSTRUCCION_CONSTRUYENDO
+#    define RECONSTRUCCION_API __declspec(dllexport)
+#  else
+#    define RECONSTRUCCION_API __declspec(dllimport)
+#  endif
+#else
+#  define RECONSTRUCCION_API
+#endif
+
+enum CodigoReconstruccion {
+    RECONSTRUCCION_OK = 0,
+    RECONSTRUCCION_ARGUMENTO_INVALIDO,   // puntero nulo, tamaño no positivo o demasiados pasos
+    RECONSTRUCCION_SIN_ENTRADAS,         // el contexto no tiene I_M o M
+    RECONSTRUCCION_ERROR_LECTURA,        // un archivo no existe o no se pudo decodificar
+    RECONSTRUCCION_ERROR_ESCRITURA,
+    RECONSTRUCCION_TAMANO_DISTINTO,      // I_D e I_M no tienen el mismo tamaño, o un
+                                         // M<i>.txt tiene menos valores que M
+    RECONSTRUCCION_SIN_SOLUCION,         // ninguna secuencia pasa las verificaciones
+    RECONSTRUCCION_SIN_MEMORIA
+};
+
+// Descripción corta del código, para registros
+RECONSTRUCCION_API const char* textoCodigoReconstruccion(CodigoReconstruccion codigo);
+
+struct ContextoReconstruccion;
+
+// Devuelve nullptr si no hay memoria. opciones.cacheSecuencias, si no es
+// nulo, debe seguir siendo válido mientras exista el contexto.
+RECONSTRUCCION_API ContextoReconstruccion*
+crearContextoReconstruccion(const OpcionesBusqueda& opciones = OpcionesBusqueda());
+
+RECONSTRUCCION_API void destruirContextoReconstruccion(ContextoReconstruccion* contexto);
+
+// I_M (width * height píxeles RGB888) y M (maskWidth * maskHeight) para los
+// trabajos del contexto. Con 'copiar' en false no se copia nada: el contexto
+// guarda los punteros y quien llama mantiene vivos los buffers mientras los
+// use el contexto.
+RECONSTRUCCION_API CodigoReconstruccion
+fijarEntradas(ContextoReconstruccion* contexto, const unsigned char* IM, int width, int height,
+              const unsigned char* mask, int maskWidth, int maskHeight, bool copiar);
+
+// Igual que fijarEntradas, cargando I_M y M de sus archivos.
+RECONSTRUCCION_API CodigoReconstruccion
+cargarEntradas(ContextoReconstruccion* contexto, const char* rutaIM, const char* rutaMascara);
+
+// Reconstruye sin copiar las entradas: 'finalImage' es I_D (width * height
+// píxeles RGB888, del mismo tamaño que I_M), maskingDataArray[i] y seeds[i]
+// son los de M<i+1>.txt y el resultado se escribe en 'salida', de
+// width * height * 3 bytes, que puede ser el mismo buffer que 'finalImage'.
+// Cada maskingDataArray[i] debe tener exactamente maskWidth * maskHeight * 3
+// bytes válidos (un byte por valor, como los deja loadSeedMasking); no se
+// puede comprobar aquí, así que quien llama debe descartar los archivos con
+// menos valores (ver comprobarEnmascaramientos).
+// Si 'secuencia' no es nulo recibe las transformaciones (opciones.profundidad,
+// o numTransformations + 1 si es 0).
+RECONSTRUCCION_API CodigoReconstruccion
+reconstruirBuffers(const ContextoReconstruccion* contexto, const unsigned char* finalImage,
+                   int width, int height, const unsigned char* const* maskingDataArray,
+                   const int* seeds, int numTransformations, unsigned char* salida,
+                   Transformation* secuencia);
+
+// Reconstruye el caso de 'directorio' (I_D.bmp y M1.txt, M2.txt, ...) y
+// escribe el BMP en 'rutaSalida'. Si el contexto no tiene entradas se usan
+// I_M.bmp y M.bmp del mismo directorio.
+RECONSTRUCCION_API CodigoReconstruccion
+reconstruirArchivos(const ContextoReconstruccion* contexto, const char* directorio,
+                    const char* rutaSalida, Transformation* secuencia);
+
+#endif // RECONSTRUCCION_H
@@ -0,0 +1,48 @@
+# Fuentes comunes a la aplicación, los benchmarks, el codificador y la
+# biblioteca (todo menos los main de cada programa)
+
+SOURCES += \
+        $$PWD/archivo_mapeado.cpp \
+        $$PWD/busqueda.cpp \
+        $$PWD/cache_imagenes.cpp \
+        $$PWD/cache_secuencias.cpp \
+        $$PWD/carga_asincrona.cpp \
+        $$PWD/carga_datos.cpp \
+        $$PWD/codificacion.cpp \
+        $$PWD/enmascaramiento.cpp \
+        $$PWD/fragmentos.cpp \
+        $$PWD/hash_rapido.cpp \
+        $$PWD/imagen_bmp.cpp \
+        $$PWD/imagenes.cpp \
+        $$PWD/lote.cpp \
+        $$PWD/memoria.cpp \
+        $$PWD/operaciones_bits.cpp \
+        $$PWD/perfilado.cpp \
+        $$PWD/reconstruccion.cpp \
+        $$PWD/reconstruccion_bandas.cpp \
+        $$PWD/servidor.cpp \
+        $$PWD/transformaciones.cpp
+
+HEADERS += \
+        $$PWD/archivo_mapeado.h \
+        $$PWD/busqueda.h \
+        $$PWD/cache_imagenes.h \
+        $$PWD/cache_secuencias.h \
+        $$PWD/carga_asincrona.h \
+        $$PWD/carga_datos.h \
+        $$PWD/codificacion.h \
+        $$PWD/enmascaramiento.h \
+        $$PWD/fragmentos.h \
+        $$PWD/hash_rapido.h \
+        $$PWD/imagen_bmp.h \
+        $$PWD/imagenes.h \
+        $$PWD/lote.h \
+        $$PWD/memoria.h \
+        $$PWD/operaciones_bits.h \
+        $$PWD/perfilado.h \
+        $$PWD/reconstruccion.h \
+        $$PWD/reconstruccion_bandas.h \
+        $$PWD/servidor.h \
+        $$PWD/transformaciones.h
+
+INCLUDEPATH += $$PWD
@@ -0,0 +1,81 @@
+#include "reconstruccion_bandas.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "memoria.h"
+#include "perfilado.h"
+
+static bool mismoTamano(const VistaBMP& a, const VistaBMP& b) {
+    return a.width == b.width && a.height == b.height;
+}
+
+bool crearVentanaDesdeBMP(VentanaDispersa& ventana,
+                          const VistaBMP& imagen, const VistaBMP& IM,
+                          const int* seeds, int numSemillas, int maskSize) {
+    ventana.arena = nullptr;
+    if (!mismoTamano(imagen, IM)) return false;
+
+    size_t imgSize = static_cast<size_t>(imagen.width) * imagen.height * 3;
+    reservarVentanaDispersa(ventana, numSemillas, maskSize);
+
+    for (int s = 0; s < numSemillas; ++s) {
+        for (int k = 0; k < maskSize; ++k) {
+            size_t pos = (seeds[s] + static_cast<size_t>(k)) % imgSize;
+            ventana.imagen[static_cast<size_t>(s) * maskSize + k] = byteRGB(imagen, pos);
+            ventana.IM[static_cast<size_t>(s) * maskSize + k] = byteRGB(IM, pos);
+        }
+    }
+    return true;
+}
+
+bool escribirInversaEnBandas(const ProgramaInverso& programa,
+                             const VistaBMP& imagen, const VistaBMP& IM,
+                             const char* rutaSalida, size_t memoriaMaxima) {
+    if (!mismoTamano(imagen, IM)) return false;
+
+    int width = imagen.width;
+    int height = imagen.height;
+    unsigned char cabecera[TAMANO_CABECERA_BMP];
+    if (!escribirCabeceraBMP(cabecera, width, height)) return false;
+
+    // El presupuesto se reparte entre el buffer de salida y las filas de
+    // I_D e I_M que están residentes mientras se procesa la banda
+    size_t stride = (static_cast<size_t>(width) * 3 + 3) & ~static_cast<size_t>(3);
+    size_t filasPorBanda = memoriaMaxima / (3 * stride);
+    if (filasPorBanda < 1) filasPorBanda = 1;
+    if (filasPorBanda > static_cast<size_t>(height)) filasPorBanda = height;
+
+    FILE* salida = fopen(rutaSalida, "wb");
+    if (!salida) return false;
+    bool ok = fwrite(cabecera, 1, sizeof(cabecera), salida) == sizeof(cabecera);
+
+    BufferBytes bufferBanda(filasPorBanda * stride);
+    unsigned char* banda = bufferBanda.datos();
+    memset(banda, 0, filasPorBanda * stride);   // el relleno de cada fila queda en cero
+    size_t bytesFila = static_cast<size_t>(width) * 3;
+
+    // La salida se guarda de abajo hacia arriba, así que se recorre desde la
+    // última fila. XOR y rotación actúan byte a byte y el orden BGR del
+    // archivo es el mismo en I_D e I_M, así que el programa se aplica a las
+    // filas tal como están en los archivos, sin convertir a RGB.
+    for (int fin = height; ok && fin > 0; ) {
+        int filas = fin < static_cast<int>(filasPorBanda) ? fin : static_cast<int>(filasPorBanda);
+        int y0 = fin - filas;
+        for (int i = 0; i < filas; ++i) {
+            int y = fin - 1 - i;
+            ejecutarPrograma(programa, banda + static_cast<size_t>(i) * stride,
+                             filaBMP(imagen, y), filaBMP(IM, y), bytesFila);
+        }
+        contarPerfil(CONTADOR_BYTES_INVERSA, static_cast<size_t>(filas) * bytesFila);
+        ok = fwrite(banda, 1, static_cast<size_t>(filas) * stride, salida) ==
+             static_cast<size_t>(filas) * stride;
+        descartarFilasBMP(imagen, y0, filas);
+        descartarFilasBMP(IM, y0, filas);
+        fin = y0;
+    }
+
+    ok = fclose(salida) == 0 && ok;
+    if (!ok) remove(rutaSalida);
+    return ok;
+}
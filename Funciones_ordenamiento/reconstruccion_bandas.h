@@ -0,0 +1,35 @@
+#ifndef RECONSTRUCCION_BANDAS_H
+#define RECONSTRUCCION_BANDAS_H
+
+#include <cstddef>
+
+#include "enmascaramiento.h"
+#include "imagen_bmp.h"
+#include "transformaciones.h"
+
+// ==============================================
+// RECONSTRUCCIÓN POR BANDAS
+// ==============================================
+// Para imágenes que no caben en memoria: la búsqueda solo necesita la
+// ventana dispersa, que se lee directamente de los BMP mapeados, y la
+// secuencia encontrada se aplica banda de filas a banda de filas desde
+// I_D/I_M hasta el archivo de salida. Nunca hay una imagen completa en RAM.
+
+// Memoria por defecto para las bandas (--memoria)
+const size_t MEMORIA_BANDAS_POR_DEFECTO = 256u * 1024 * 1024;
+
+// Igual que crearVentanaDispersa, pero tomando los bytes de los archivos.
+// Devuelve false si las dos imágenes no tienen el mismo tamaño.
+bool crearVentanaDesdeBMP(VentanaDispersa& ventana,
+                          const VistaBMP& imagen, const VistaBMP& IM,
+                          const int* seeds, int numSemillas, int maskSize);
+
+// Aplica el programa a 'imagen' (con 'IM') y escribe el resultado como BMP
+// de 24 bits en 'rutaSalida', usando como mucho unos 'memoriaMaxima' bytes
+// entre el buffer de salida y las páginas de entrada residentes. Devuelve
+// false si las imágenes no coinciden en tamaño o no se pudo escribir.
+bool escribirInversaEnBandas(const ProgramaInverso& programa,
+                             const VistaBMP& imagen, const VistaBMP& IM,
+                             const char* rutaSalida, size_t memoriaMaxima);
+
+#endif // RECONSTRUCCION_BANDAS_H
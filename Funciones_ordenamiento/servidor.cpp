@@ -0,0 +1,287 @@
+#include "servidor.h"
+
+#include <QString>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "cache_imagenes.h"
+#include "carga_datos.h"
+#include "codificacion.h"
+#include "imagenes.h"
+
+// Una petición más larga que esto cierra la conexión
+static const size_t MAXIMO_PETICION = 64 * 1024;
+
+struct Peticion {
+    std::string orden;
+    std::string directorio, im, mascara, salida;
+    std::string claveDesconocida;
+};
+
+struct EstadoServidor {
+    explicit EstadoServidor(size_t capacidadCache) : cache(capacidadCache) {}
+
+    CacheImagenes cache;
+    OpcionesBusqueda busqueda;
+    std::atomic<unsigned long long> trabajos{0};
+
+    // Conexiones abiertas, para cerrarlas al terminar y esperar a sus hilos
+    std::mutex mutex;
+    std::condition_variable sinConexiones;
+    std::set<int> conexiones;
+};
+
+// ==============================================
+// TRABAJOS
+// ==============================================
+
+static std::string reconstruir(const Peticion& peticion, EstadoServidor& estado) {
+    if (peticion.directorio.empty()) return "error falta el directorio";
+    const std::string& dir = peticion.directorio;
+    std::string rutaIM = peticion.im.empty() ? dir + "/I_M.bmp" : peticion.im;
+    std::string rutaMascara = peticion.mascara.empty() ? dir + "/M.bmp" : peticion.mascara;
+    std::string salida = peticion.salida.empty() ? dir + "/reconstructed.bmp" : peticion.salida;
+
+    int width, height;
+    BufferBytes finalImage = loadPixels(QString::fromStdString(dir + "/I_D.bmp"), width, height);
+    if (!finalImage) return "error no se pudo cargar " + dir + "/I_D.bmp";
+    std::shared_ptr<const ImagenCacheada> IM = estado.cache.obtener(rutaIM);
+    if (!IM) return "error no se pudo cargar " + rutaIM;
+    std::shared_ptr<const ImagenCacheada> mask = estado.cache.obtener(rutaMascara);
+    if (!mask) return "error no se pudo cargar " + rutaMascara;
+    if (IM->width != width || IM->height != height) {
+        return "error I_D.bmp e I_M.bmp no tienen el mismo tamaño";
+    }
+
+    std::vector<BufferBytes> datosEnmascaramiento;
+    std::vector<int> seeds, pixeles;
+    std::string error;
+    int numTransformations = cargarArchivosEnmascaramiento(
+        dir.c_str(), MAX_PASOS - 1, datosEnmascaramiento, seeds, pixeles, error);
+    if (numTransformations == 0) return "error " + error;
+    // La máscara la elige el cliente: un enmascaramiento más corto que ella
+    // haría leer a la búsqueda fuera del buffer
+    if (!comprobarEnmascaramientos(pixeles, static_cast<size_t>(mask->width) * mask->height * 3,
+                                   error)) {
+        return "error " + error;
+    }
+    std::vector<unsigned char*> maskingDataArray;
+    for (BufferBytes& datos : datosEnmascaramiento) maskingDataArray.push_back(datos.datos());
+
+    Transformation secuencia[MAX_PASOS];
+    std::unique_ptr<unsigned char[]> resultado(
+        reconstructImage(finalImage.datos(), IM->pixeles.datos(), mask->pixeles.datos(),
+                         width, height, mask->width, mask->height, maskingDataArray.data(),
+                         seeds.data(), numTransformations, secuencia, estado.busqueda));
+    if (!resultado) return "error no se pudo reconstruir la imagen";
+    finalImage.liberar();
+    if (!exportImage(resultado.get(), width, height, QString::fromStdString(salida))) {
+        return "error al escribir " + salida;
+    }
+    ++estado.trabajos;
+
+    int profundidad = estado.busqueda.profundidad > 0 ? estado.busqueda.profundidad
+                                                      : numTransformations + 1;
+    char texto[MAX_PASOS * 4 + 1];
+    escribirSecuencia(secuencia, profundidad, texto, sizeof(texto));
+    return std::string("ok ") + texto + " " + salida;
+}
+
+static std::string responder(const Peticion& peticion, EstadoServidor& estado) {
+    if (!peticion.claveDesconocida.empty()) {
+        return "error clave desconocida: " + peticion.claveDesconocida;
+    }
+    if (peticion.orden == "reconstruir") return reconstruir(peticion, estado);
+    if (peticion.orden == "estado") {
+        CacheImagenes::Estadisticas e = estado.cache.estadisticas();
+        return "ok cache " + std::to_string(e.entradas) + " " + std::to_string(e.bytes) +
+               " aciertos " + std::to_string(e.aciertos) + " fallos " + std::to_string(e.fallos) +
+               " trabajos " + std::to_string(estado.trabajos.load());
+    }
+    return "error orden desconocida: " + peticion.orden;
+}
+
+// ==============================================
+// CONEXIONES
+// ==============================================
+
+#ifndef _WIN32
+
+static bool enviarLinea(int fd, const std::string& linea) {
+    std::string datos = linea + "\n";
+    size_t enviados = 0;
+    while (enviados < datos.size()) {
+        ssize_t n = send(fd, datos.data() + enviados, datos.size() - enviados, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        enviados += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Interpreta una línea de la petición en curso. Devuelve true cuando la
+// petición está completa (línea vacía tras la orden).
+static bool agregarLinea(Peticion& peticion, std::string linea) {
+    if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+    if (linea.empty()) return !peticion.orden.empty();
+    if (peticion.orden.empty()) {
+        peticion.orden = linea;
+        return false;
+    }
+    size_t espacio = linea.find(' ');
+    std::string clave = linea.substr(0, espacio);
+    std::string valor = espacio == std::string::npos ? "" : linea.substr(espacio + 1);
+    if (clave == "directorio") peticion.directorio = valor;
+    else if (clave == "im") peticion.im = valor;
+    else if (clave == "mascara") peticion.mascara = valor;
+    else if (clave == "salida") peticion.salida = valor;
+    else peticion.claveDesconocida = clave;
+    return false;
+}
+
+static void atenderConexion(int fd, EstadoServidor* estado) {
+    std::string pendiente;
+    Peticion peticion;
+    char buffer[4096];
+    bool abierta = true;
+    while (abierta) {
+        size_t fin;
+        while (abierta && (fin = pendiente.find('\n')) != std::string::npos) {
+            bool completa = agregarLinea(peticion, pendiente.substr(0, fin));
+            pendiente.erase(0, fin + 1);
+            if (completa) {
+                abierta = enviarLinea(fd, responder(peticion, *estado));
+                peticion = Peticion();
+            }
+        }
+        if (!abierta || pendiente.size() > MAXIMO_PETICION) break;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        pendiente.append(buffer, static_cast<size_t>(n));
+    }
+
+    // Se cierra con el cerrojo tomado: si no, accept podría reutilizar el
+    // número antes de borrarlo del conjunto, y el cierre del servidor haría
+    // shutdown sobre una conexión que no es esta
+    std::lock_guard<std::mutex> bloqueo(estado->mutex);
+    estado->conexiones.erase(fd);
+    close(fd);
+    if (estado->conexiones.empty()) estado->sinConexiones.notify_all();
+}
+
+static volatile std::sig_atomic_t terminar = 0;
+
+static void alRecibirSenal(int) {
+    terminar = 1;
+}
+
+enum EstadoRuta { RUTA_LIBRE, RUTA_NO_ES_SOCKET, RUTA_EN_USO };
+
+// Borra un socket que haya quedado de una ejecución anterior, pero nunca un
+// archivo que no sea un socket ni uno en el que otro servidor siga
+// escuchando. Solo se da por abandonado si connect lo rechaza: cualquier
+// otro error (p. ej. la cola de un servidor vivo llena) cuenta como en uso.
+static EstadoRuta liberarRuta(const sockaddr_un& direccion) {
+    struct stat info;
+    if (lstat(direccion.sun_path, &info) != 0) return RUTA_LIBRE;
+    if (!S_ISSOCK(info.st_mode)) return RUTA_NO_ES_SOCKET;
+
+    int prueba = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (prueba < 0) return RUTA_EN_USO;
+    bool abandonado =
+        connect(prueba, reinterpret_cast<const sockaddr*>(&direccion), sizeof(direccion)) != 0 &&
+        errno == ECONNREFUSED;
+    close(prueba);
+    if (!abandonado) return RUTA_EN_USO;
+    unlink(direccion.sun_path);
+    return RUTA_LIBRE;
+}
+
+#endif // _WIN32
+
+// ==============================================
+// BUCLE PRINCIPAL
+// ==============================================
+
+bool ejecutarServidor(const OpcionesServidor& opciones) {
+#ifdef _WIN32
+    (void)opciones;
+    std::cerr << "El modo servidor necesita sockets de dominio Unix" << std::endl;
+    return false;
+#else
+    const char* ruta = opciones.rutaSocket.c_str();
+    sockaddr_un direccion = {};
+    direccion.sun_family = AF_UNIX;
+    if (opciones.rutaSocket.size() >= sizeof(direccion.sun_path)) {
+        std::cerr << "Ruta de socket demasiado larga: " << ruta << std::endl;
+        return false;
+    }
+    strcpy(direccion.sun_path, ruta);
+    EstadoRuta estadoRuta = liberarRuta(direccion);
+    if (estadoRuta == RUTA_NO_ES_SOCKET) {
+        std::cerr << "Ya existe un archivo que no es un socket: " << ruta << std::endl;
+        return false;
+    }
+    if (estadoRuta == RUTA_EN_USO) {
+        std::cerr << "Otro servidor ya escucha en " << ruta << std::endl;
+        return false;
+    }
+
+    int servidor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (servidor < 0 ||
+        bind(servidor, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 ||
+        listen(servidor, 64) != 0) {
+        std::cerr << "No se pudo abrir el socket " << ruta << ": " << strerror(errno) << std::endl;
+        if (servidor >= 0) close(servidor);
+        return false;
+    }
+
+    std::signal(SIGINT, alRecibirSenal);
+    std::signal(SIGTERM, alRecibirSenal);
+    std::cout << "Escuchando en " << ruta << std::endl;
+
+    EstadoServidor estado(opciones.capacidadCache);
+    estado.busqueda = opciones.busqueda;
+
+    // poll con espera corta en lugar de accept bloqueante: así la señal se
+    // nota aunque la reciba otro hilo
+    while (!terminar) {
+        pollfd espera = {servidor, POLLIN, 0};
+        if (poll(&espera, 1, 200) <= 0) continue;
+        int cliente = accept4(servidor, nullptr, nullptr, SOCK_CLOEXEC);
+        if (cliente < 0) continue;
+        {
+            std::lock_guard<std::mutex> bloqueo(estado.mutex);
+            estado.conexiones.insert(cliente);
+        }
+        std::thread(atenderConexion, cliente, &estado).detach();
+    }
+
+    close(servidor);
+    unlink(ruta);
+
+    // Las conexiones abiertas terminan el trabajo en curso y se cierran
+    std::unique_lock<std::mutex> bloqueo(estado.mutex);
+    for (int fd : estado.conexiones) shutdown(fd, SHUT_RD);
+    estado.sinConexiones.wait(bloqueo, [&estado] { return estado.conexiones.empty(); });
+    return true;
+#endif
+}
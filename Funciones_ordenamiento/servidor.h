@@ -0,0 +1,47 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <string>
+
+#include "busqueda.h"
+
+// ==============================================
+// MODO SERVIDOR
+// ==============================================
+// Proceso residente que atiende trabajos por un socket de dominio Unix. I_M
+// y M se guardan decodificadas en una CacheImagenes, así que cada trabajo
+// solo paga por leer I_D y los enmascaramientos, buscar y escribir.
+//
+// Protocolo de texto. Una petición es una línea con la orden, líneas
+// "clave valor" y una línea vacía; la respuesta es una sola línea. Por una
+// misma conexión se pueden mandar varias peticiones seguidas.
+//
+//   reconstruir
+//   directorio /casos/0001        M1.txt, M2.txt, ... e I_D.bmp
+//   im /comun/I_M.bmp             opcional, por defecto directorio/I_M.bmp
+//   mascara /comun/M.bmp          opcional, por defecto directorio/M.bmp
+//   salida /salidas/0001.bmp      opcional, por defecto directorio/reconstructed.bmp
+//   <línea vacía>
+//
+//   -> ok X,R3,X /salidas/0001.bmp
+//   -> error <motivo>
+//
+//   estado
+//   <línea vacía>
+//
+//   -> ok cache <entradas> <bytes> aciertos <n> fallos <n> trabajos <n>
+//
+// Cada conexión se atiende en su propio hilo y los trabajos corren a la vez.
+
+struct OpcionesServidor {
+    std::string rutaSocket;
+    size_t capacidadCache = 512u * 1024 * 1024;
+    OpcionesBusqueda busqueda;   // numHilos es por trabajo
+};
+
+// Atiende peticiones hasta recibir SIGINT o SIGTERM y luego borra el socket.
+// Devuelve false (tras avisar por cerr) si no se pudo abrir el socket o el
+// sistema no tiene sockets de dominio Unix.
+bool ejecutarServidor(const OpcionesServidor& opciones);
+
+#endif // SERVIDOR_H
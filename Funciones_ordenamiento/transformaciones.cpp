@@ -0,0 +1,135 @@
+#include "transformaciones.h"
+
+#include <cstring>
+
+#include "operaciones_bits.h"
+#include "perfilado.h"
+
+// Tamaño de bloque del ejecutor fusionado: el bloque de la imagen y el de IM
+// caben juntos en la caché L1.
+static const size_t BLOQUE_FUSIONADO = 16 * 1024;
+
+static_assert(CATALOGO_COMPLETO.cantidad == NUM_TRANSFORMACIONES, "catálogo incompleto");
+static_assert(CATALOGO_CANONICO.cantidad == 1 + MAX_BITS, "una transformación por clase");
+static_assert(pasoInverso({ROTATE_RIGHT_OP, 3}).bits == 3 &&
+              pasoInverso({ROTATE_LEFT_OP, 3}).bits == 5 &&
+              pasoInverso({ROTATE_RIGHT_OP, MAX_BITS}).bits == 0,
+              "la inversa de una rotación derecha es la izquierda de los mismos bits");
+
+// Kernel del nivel SIMD activo para un paso que no es la identidad
+static KernelPaso kernelDe(const PasoCompilado& paso) {
+    return paso.tipo == PASO_XOR ? kernelXOR() : kernelRotacionIzquierda(paso.bits);
+}
+
+// ==============================================
+// COMPILACIÓN DE SECUENCIAS INVERSAS
+// ==============================================
+
+bool compilarInversa(const Transformation* transformations, int numTransformations,
+                     ProgramaInverso& programa) {
+    programa.numPasos = 0;
+    if (numTransformations > MAX_PASOS) return false;
+
+    // Se recorre en orden inverso y se usa el programa como pila: cada paso
+    // nuevo se combina con el de la cima si son del mismo tipo.
+    for (int i = numTransformations - 1; i >= 0; --i) {
+        PasoCompilado paso = pasoInverso(transformations[i]);
+        if (paso.tipo == PASO_ROTAR_IZQ && paso.bits == 0) continue;
+
+        if (programa.numPasos > 0) {
+            PasoCompilado& cima = programa.pasos[programa.numPasos - 1];
+            if (cima.tipo == PASO_XOR && paso.tipo == PASO_XOR) {
+                --programa.numPasos;
+                continue;
+            }
+            if (cima.tipo == PASO_ROTAR_IZQ && paso.tipo == PASO_ROTAR_IZQ) {
+                cima.bits = (cima.bits + paso.bits) % MAX_BITS;
+                if (cima.bits == 0) --programa.numPasos;
+                continue;
+            }
+        }
+        programa.pasos[programa.numPasos++] = paso;
+    }
+
+    // Los kernels se eligen una vez, con los pasos ya combinados
+    for (int p = 0; p < programa.numPasos; ++p) {
+        programa.pasos[p].kernel = kernelDe(programa.pasos[p]);
+    }
+    return true;
+}
+
+// ==============================================
+// EJECUCIÓN FUSIONADA
+// ==============================================
+
+void ejecutarPrograma(const ProgramaInverso& programa, unsigned char* destino,
+                      const unsigned char* origen, const unsigned char* IM, size_t size) {
+    for (size_t inicio = 0; inicio < size; inicio += BLOQUE_FUSIONADO) {
+        size_t n = size - inicio < BLOQUE_FUSIONADO ? size - inicio : BLOQUE_FUSIONADO;
+        unsigned char* bloque = destino + inicio;
+        if (destino != origen) memcpy(bloque, origen + inicio, n);
+
+        for (int p = 0; p < programa.numPasos; ++p) {
+            programa.pasos[p].kernel(bloque, IM + inicio, n);
+        }
+    }
+}
+
+void applyTransformation(unsigned char* img, const unsigned char* IM,
+                         const Transformation& t, size_t size) {
+    PasoCompilado paso = pasoDirecto(t);
+    if (paso.tipo == PASO_ROTAR_IZQ && paso.bits == 0) return;
+    kernelDe(paso)(img, IM, size);
+}
+
+unsigned char* applyInverseTransformations(unsigned char* finalImage,
+                                           unsigned char* IM,
+                                           const Transformation* transformations,
+                                           int numTransformations,
+                                           int width, int height) {
+    size_t size = static_cast<size_t>(width) * height * 3;
+    unsigned char* current = new unsigned char[size];
+    if (!aplicarInversaEn(current, finalImage, IM, transformations, numTransformations, size)) {
+        delete[] current;
+        return nullptr;
+    }
+    return current;
+}
+
+bool aplicarInversaEn(unsigned char* destino, const unsigned char* finalImage,
+                      const unsigned char* IM, const Transformation* transformations,
+                      int numTransformations, size_t size) {
+    MedicionFase medicion(FASE_INVERSA);
+    ProgramaInverso programa;
+    if (!compilarInversa(transformations, numTransformations, programa)) {
+        return false;
+    }
+    ejecutarPrograma(programa, destino, finalImage, IM, size);
+    contarPerfil(CONTADOR_BYTES_INVERSA, size);
+    return true;
+}
+
+void generatePossibleTransformations(Transformation* transforms, int& count) {
+    // El catálogo ya está generado en tiempo de compilación
+    count = CATALOGO_COMPLETO.cantidad;
+    for (int i = 0; i < count; ++i) transforms[i] = CATALOGO_COMPLETO.ops[i];
+}
+
+// ==============================================
+// SECUENCIAS CANÓNICAS
+// ==============================================
+
+bool esIdentidad(const Transformation& t) {
+    return t.type != XOR_OP && t.bits % MAX_BITS == 0;
+}
+
+void generarCatalogoCanonico(Transformation* transforms, int& count) {
+    count = CATALOGO_CANONICO.cantidad;
+    for (int i = 0; i < count; ++i) transforms[i] = CATALOGO_CANONICO.ops[i];
+}
+
+bool admiteCanonico(const Transformation& actual, const Transformation& posterior) {
+    if (esIdentidad(actual)) return true;
+    if (esIdentidad(posterior)) return false;
+    return (actual.type == XOR_OP) != (posterior.type == XOR_OP);
+}
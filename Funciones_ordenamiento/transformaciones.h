@@ -0,0 +1,167 @@
+#ifndef TRANSFORMACIONES_H
+#define TRANSFORMACIONES_H
+
+#include <cstddef>
+
+#include "operaciones_bits.h"
+
+// ==============================================
+// TRANSFORMACIONES Y EJECUTOR FUSIONADO
+// ==============================================
+
+enum TransformationType { XOR_OP, ROTATE_RIGHT_OP, ROTATE_LEFT_OP };
+
+struct Transformation {
+    TransformationType type;
+    int bits;
+};
+
+// Máximo de pasos que admite un programa compilado
+const int MAX_PASOS = 32;
+
+// ==============================================
+// CATÁLOGO EN TIEMPO DE COMPILACIÓN
+// ==============================================
+
+// XOR y rotaciones derecha e izquierda de 1 a MAX_BITS bits
+constexpr int NUM_TRANSFORMACIONES = 1 + 2 * MAX_BITS;
+
+// Versión del conjunto de operaciones. Se sube cuando cambia lo que hace
+// alguna transformación o cuál secuencia elige la búsqueda; forma parte de
+// la clave de la caché de secuencias, así que invalida lo guardado.
+constexpr int VERSION_OPERACIONES = 1;
+
+struct CatalogoTransformaciones {
+    Transformation ops[NUM_TRANSFORMACIONES];
+    int cantidad;
+};
+
+// En el orden de generatePossibleTransformations: XOR, rotaciones derecha de
+// 1..MAX_BITS y rotaciones izquierda de 1..MAX_BITS.
+constexpr CatalogoTransformaciones generarCatalogoCompleto() {
+    CatalogoTransformaciones c = {};
+    c.ops[c.cantidad++] = {XOR_OP, 0};
+    for (int bits = 1; bits <= MAX_BITS; ++bits) c.ops[c.cantidad++] = {ROTATE_RIGHT_OP, bits};
+    for (int bits = 1; bits <= MAX_BITS; ++bits) c.ops[c.cantidad++] = {ROTATE_LEFT_OP, bits};
+    return c;
+}
+
+// Rotación izquierda de 0..MAX_BITS-1 bits equivalente a 't' (no vale para XOR)
+constexpr int rotacionIzquierda(const Transformation& t) {
+    return t.type == ROTATE_LEFT_OP ? t.bits % MAX_BITS
+                                    : (MAX_BITS - t.bits % MAX_BITS) % MAX_BITS;
+}
+
+// Clase de equivalencia: 0 = XOR, 1 + k = rotación izquierda de k bits
+constexpr int claseTransformacion(const Transformation& t) {
+    return t.type == XOR_OP ? 0 : 1 + rotacionIzquierda(t);
+}
+
+// La primera transformación del catálogo completo de cada clase
+constexpr CatalogoTransformaciones generarCatalogoCanonicoConstante() {
+    CatalogoTransformaciones completo = generarCatalogoCompleto();
+    CatalogoTransformaciones c = {};
+    bool vista[1 + MAX_BITS] = {};
+    for (int i = 0; i < completo.cantidad; ++i) {
+        int clase = claseTransformacion(completo.ops[i]);
+        if (!vista[clase]) {
+            vista[clase] = true;
+            c.ops[c.cantidad++] = completo.ops[i];
+        }
+    }
+    return c;
+}
+
+constexpr CatalogoTransformaciones CATALOGO_COMPLETO = generarCatalogoCompleto();
+constexpr CatalogoTransformaciones CATALOGO_CANONICO = generarCatalogoCanonicoConstante();
+
+// ==============================================
+// PROGRAMAS INVERSOS
+// ==============================================
+
+// Paso de un programa ya simplificado: toda rotación se expresa como
+// rotación izquierda de 1..7 bits. 'kernel' es la función que lo ejecuta,
+// elegida al compilar el programa según el nivel SIMD activo.
+enum TipoPaso { PASO_XOR, PASO_ROTAR_IZQ };
+
+struct PasoCompilado {
+    TipoPaso tipo;
+    int bits;
+    KernelPaso kernel;
+};
+
+// Paso que deshace 't' (sin kernel). Una rotación izquierda de 0 bits es la
+// identidad.
+constexpr PasoCompilado pasoInverso(const Transformation& t) {
+    return t.type == XOR_OP ? PasoCompilado{PASO_XOR, 0, nullptr}
+                            : PasoCompilado{PASO_ROTAR_IZQ,
+                                            (MAX_BITS - rotacionIzquierda(t)) % MAX_BITS, nullptr};
+}
+
+// Paso que aplica 't' en el sentido directo (sin kernel)
+constexpr PasoCompilado pasoDirecto(const Transformation& t) {
+    return t.type == XOR_OP ? PasoCompilado{PASO_XOR, 0, nullptr}
+                            : PasoCompilado{PASO_ROTAR_IZQ, rotacionIzquierda(t), nullptr};
+}
+
+// Secuencia inversa compilada: los pasos están en el orden en que se aplican
+// (el inverso de la última transformación va primero), las rotaciones
+// consecutivas están combinadas y los pares de XOR consecutivos cancelados.
+struct ProgramaInverso {
+    PasoCompilado pasos[MAX_PASOS];
+    int numPasos;
+};
+
+// Compila la inversa de 'transformations'. Devuelve false si hay más de
+// MAX_PASOS transformaciones.
+bool compilarInversa(const Transformation* transformations, int numTransformations,
+                     ProgramaInverso& programa);
+
+// Aplica el programa a 'origen' dejando el resultado en 'destino' (pueden ser
+// el mismo buffer). Recorre la imagen una sola vez, por bloques que caben en
+// caché, aplicando todos los pasos a cada bloque antes de pasar al siguiente.
+void ejecutarPrograma(const ProgramaInverso& programa, unsigned char* destino,
+                      const unsigned char* origen, const unsigned char* IM, size_t size);
+
+// Aplica una transformación en el sentido directo (el del cifrado) sobre
+// 'size' bytes de 'img'; IM solo se usa para XOR.
+void applyTransformation(unsigned char* img, const unsigned char* IM,
+                         const Transformation& t, size_t size);
+
+unsigned char* applyInverseTransformations(unsigned char* finalImage,
+                                           unsigned char* IM,
+                                           const Transformation* transformations,
+                                           int numTransformations,
+                                           int width, int height);
+
+// Igual que applyInverseTransformations pero escribiendo en 'destino'
+// ('size' bytes, puede ser el mismo buffer que 'finalImage'). Devuelve false
+// si hay más de MAX_PASOS transformaciones.
+bool aplicarInversaEn(unsigned char* destino, const unsigned char* finalImage,
+                      const unsigned char* IM, const Transformation* transformations,
+                      int numTransformations, size_t size);
+
+void generatePossibleTransformations(Transformation* transforms, int& count);
+
+// ==============================================
+// SECUENCIAS CANÓNICAS
+// ==============================================
+// Muchas secuencias son equivalentes: rotar k a la derecha es rotar 8-k a la
+// izquierda, las rotaciones de 8 bits son la identidad, dos XOR seguidos se
+// cancelan y dos rotaciones seguidas se combinan en una.
+
+// Una transformación por cada función distinta sobre los bytes: XOR y las
+// rotaciones derecha de 1 a 8 bits (la de 8 es la identidad). Cada una es la
+// primera de su clase en el orden de generatePossibleTransformations.
+void generarCatalogoCanonico(Transformation* transforms, int& count);
+
+bool esIdentidad(const Transformation& t);
+
+// Indica si 'actual' puede ir justo antes de 'posterior' en una secuencia
+// canónica cuando la imagen intermedia entre ambas no se verifica. Dentro de
+// un tramo sin verificar solo se admiten secuencias reducidas (sin dos XOR ni
+// dos rotaciones seguidas) con las identidades al principio; cualquier otra
+// es equivalente a una de estas.
+bool admiteCanonico(const Transformation& actual, const Transformation& posterior);
+
+#endif // TRANSFORMACIONES_H